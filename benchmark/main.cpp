@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include "kernels.hpp"
+#include "processing.hpp"
+#include "worker_pool.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Resolution
+{
+    std::string name;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct Benchmark
+{
+    bool overlay_enabled;
+    Application::Processing::PixelFormat input_pixel_format;
+    Application::Processing::PixelFormat output_pixel_format;
+};
+
+struct Result
+{
+    double mean_ns;
+    double min_ns;
+};
+
+Application::Processing::FrameDescriptor make_frame_descriptor(const Resolution& resolution, Application::Processing::PixelFormat pixel_format)
+{
+    return { resolution.width, resolution.height, Application::Processing::line_stride(pixel_format, resolution.width), pixel_format, Application::Processing::FieldOrder::progressive };
+}
+
+Result run(Application::Processing::Processor& processor, const std::vector<uint8_t>& input, std::vector<std::vector<uint8_t>>& outputs, unsigned int iterations)
+{
+    // Warm-up pass over every output buffer, the same way TX slots are recycled
+    for (auto& output : outputs)
+        processor.process(input.data(), output.data(), Application::Threading::WorkerPool::Clock::time_point::max());
+
+    double total_ns = 0.0, min_ns = 0.0;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        auto& output = outputs[i % outputs.size()];
+
+        const auto start = Clock::now();
+        processor.process(input.data(), output.data(), Application::Threading::WorkerPool::Clock::time_point::max());
+        const double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+        total_ns += elapsed_ns;
+        min_ns = (i == 0) ? elapsed_ns : std::min(min_ns, elapsed_ns);
+    }
+
+    return { total_ns / iterations, min_ns };
+}
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Benchmarks the processing kernels on synthetic frames"};
+    unsigned int iterations = 100;
+    app.add_option("-n,--iterations", iterations, "Number of measured frames per configuration");
+    std::vector<unsigned int> thread_counts;
+    app.add_option("-t,--threads", thread_counts, "Comma-separated list of processing thread counts (defaults to powers of two up to the number of cores)")->delimiter(',');
+    std::vector<std::string> resolution_names;
+    app.add_option("-r,--resolutions", resolution_names, "Comma-separated list of resolutions among HD, 3G, 4K and 8K (defaults to all)")->delimiter(',');
+    unsigned int number_of_slots = 4;
+    app.add_option("--slots", number_of_slots, "Number of recycled output buffers");
+    CLI11_PARSE(app, argc, argv);
+
+    const std::vector<Resolution> resolutions = {
+        { "HD", 1280, 720 },
+        { "3G", 1920, 1080 },
+        { "4K", 3840, 2160 },
+        { "8K", 7680, 4320 },
+    };
+
+    const std::vector<Benchmark> benchmarks = {
+        { true, Application::Processing::PixelFormat::rgb_24, Application::Processing::PixelFormat::rgba_32 },
+        { true, Application::Processing::PixelFormat::yuv_422_8, Application::Processing::PixelFormat::rgba_32 },
+        { true, Application::Processing::PixelFormat::yuv_422_10, Application::Processing::PixelFormat::rgba_32 },
+        { true, Application::Processing::PixelFormat::rgb_30, Application::Processing::PixelFormat::rgba_32 },
+        { false, Application::Processing::PixelFormat::rgb_24, Application::Processing::PixelFormat::rgb_24 },
+    };
+
+    if (thread_counts.empty())
+    {
+        const unsigned int hardware_concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int thread_count = 1; thread_count < hardware_concurrency; thread_count *= 2)
+            thread_counts.push_back(thread_count);
+        thread_counts.push_back(hardware_concurrency);
+    }
+
+    std::cout << "Processing kernels: " << Application::Kernels::to_string(Application::Kernels::detect_instruction_set()) << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(14) << "processor" << std::setw(18) << "input" << std::setw(6) << "res" << std::right << std::setw(9) << "threads"
+              << std::setw(14) << "mean ns" << std::setw(14) << "min ns" << std::setw(10) << "GB/s" << std::setw(10) << "speedup"
+              << std::setw(12) << "% of 60Hz" << std::endl;
+
+    for (const auto& resolution : resolutions)
+    {
+        if (!resolution_names.empty() && std::find(resolution_names.begin(), resolution_names.end(), resolution.name) == resolution_names.end())
+            continue;
+
+        for (const auto& benchmark : benchmarks)
+        {
+            const auto input_frame_descriptor = make_frame_descriptor(resolution, benchmark.input_pixel_format);
+            std::vector<uint8_t> input(input_frame_descriptor.size());
+            for (size_t i = 0; i < input.size(); ++i)
+                input[i] = static_cast<uint8_t>(i * 31);
+
+            const auto output_frame_descriptor = make_frame_descriptor(resolution, benchmark.output_pixel_format);
+            std::vector<std::vector<uint8_t>> outputs(std::max(number_of_slots, 1u), std::vector<uint8_t>(output_frame_descriptor.size(), 0));
+            const double bytes_per_frame = static_cast<double>(input.size() + outputs.front().size());
+
+            double single_thread_mean_ns = 0.0;
+            for (unsigned int thread_count : thread_counts)
+            {
+                Application::Threading::WorkerPool worker_pool(std::max(thread_count, 1u) - 1);
+                auto processor = Application::Processing::create_processor(benchmark.overlay_enabled, input_frame_descriptor, output_frame_descriptor, worker_pool);
+                if (!processor)
+                    return -1;
+
+                const auto result = run(*processor, input, outputs, iterations);
+                if (single_thread_mean_ns == 0.0)
+                    single_thread_mean_ns = result.mean_ns;
+
+                std::cout << std::left << std::setw(14) << processor->name() << std::setw(18) << Application::Processing::to_string(benchmark.input_pixel_format) << std::setw(6) << resolution.name << std::right << std::setw(9) << worker_pool.concurrency()
+                          << std::fixed << std::setprecision(0) << std::setw(14) << result.mean_ns << std::setw(14) << result.min_ns
+                          << std::setprecision(2) << std::setw(10) << bytes_per_frame / result.mean_ns
+                          << std::setw(10) << single_thread_mean_ns / result.mean_ns
+                          << std::setprecision(1) << std::setw(12) << result.mean_ns / 1e6 / (1000.0 / 60.0) * 100.0 << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -16,8 +16,19 @@
 #include "allocation.hpp"
 
 #include <iostream>
+#include <new>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <tuple>
 
-#if !defined(__linux__) && !defined(__APPLE__)
+#if defined(__linux__)
+#include <filesystem>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif !defined(__APPLE__)
 #include <Windows.h>
 #endif
 
@@ -49,4 +60,224 @@ namespace Application::Allocation
     #endif
         buffer_descriptor.pBuffer = nullptr;
     }
+
+    std::optional<unsigned int> numa_node_of_core(unsigned int core)
+    {
+    #if defined(__linux__)
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(core), error))
+        {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) == 0 && name.size() > 4 && name.find_first_not_of("0123456789", 4) == std::string::npos)
+                return static_cast<unsigned int>(std::stoul(name.substr(4)));
+        }
+        return std::nullopt;
+    #elif !defined(__APPLE__)
+        UCHAR node = 0;
+        if (core > 0xFF || !GetNumaProcessorNode(static_cast<UCHAR>(core), &node) || node == 0xFF)
+            return std::nullopt;
+        return node;
+    #else
+        return std::nullopt;
+    #endif
+    }
+
+    BufferPool::BufferPool(bool huge_pages_enabled, std::optional<unsigned int> numa_node)
+        : _huge_pages_enabled(huge_pages_enabled)
+        , _numa_node(numa_node)
+    {
+    }
+
+    BufferPool::~BufferPool()
+    {
+        for (const auto& block : _blocks)
+            deallocate(block);
+    }
+
+    VHD_APPLICATION_BUFFER_DESCRIPTOR BufferPool::acquire(ULONG buffer_size)
+    {
+        std::lock_guard lock(_mutex);
+
+        Block* free_block = nullptr;
+        for (auto& block : _blocks)
+        {
+            if (!block.in_use && block.mapped_size >= buffer_size && (!free_block || block.mapped_size < free_block->mapped_size))
+                free_block = &block;
+        }
+
+        if (!free_block)
+        {
+            for (auto it = _blocks.begin(); it != _blocks.end();)
+            {
+                if (it->in_use)
+                    ++it;
+                else
+                {
+                    deallocate(*it);
+                    it = _blocks.erase(it);
+                }
+            }
+
+            Block block = allocate(buffer_size);
+            if (!block.buffer)
+                throw std::bad_alloc();
+            _blocks.push_back(block);
+            free_block = &_blocks.back();
+            report(*free_block);
+        }
+
+        free_block->in_use = true;
+        free_block->buffer_size = buffer_size;
+
+        VHD_APPLICATION_BUFFER_DESCRIPTOR buffer_descriptor;
+        buffer_descriptor.Size = sizeof(buffer_descriptor);
+        buffer_descriptor.RDMAEnabled = FALSE;
+        buffer_descriptor.pBuffer = free_block->buffer;
+        return buffer_descriptor;
+    }
+
+    void BufferPool::release(const VHD_APPLICATION_BUFFER_DESCRIPTOR& buffer_descriptor)
+    {
+        std::lock_guard lock(_mutex);
+        for (auto& block : _blocks)
+        {
+            if (block.buffer == buffer_descriptor.pBuffer)
+                block.in_use = false;
+        }
+    }
+
+    void BufferPool::reserve(unsigned int number_of_buffers, ULONG buffer_size)
+    {
+        std::vector<VHD_APPLICATION_BUFFER_DESCRIPTOR> buffer_descriptors;
+        try
+        {
+            for (unsigned int i = 0; i < number_of_buffers; ++i)
+                buffer_descriptors.push_back(acquire(buffer_size));
+        }
+        catch (const std::bad_alloc&)
+        {
+            for (const auto& buffer_descriptor : buffer_descriptors)
+                release(buffer_descriptor);
+            throw;
+        }
+        for (const auto& buffer_descriptor : buffer_descriptors)
+            release(buffer_descriptor);
+    }
+
+    BufferPool::Block BufferPool::allocate(ULONG buffer_size)
+    {
+        Block block = { nullptr, buffer_size, buffer_size, PageSize::regular, false, false };
+
+    #if defined(__linux__)
+        const size_t huge_page_2mb = size_t(1) << 21, huge_page_1gb = size_t(1) << 30;
+        if (_huge_pages_enabled)
+        {
+            for (auto [ page_size, page_bytes, page_shift ] : { std::make_tuple(PageSize::huge_1gb, huge_page_1gb, 30), std::make_tuple(PageSize::huge_2mb, huge_page_2mb, 21) })
+            {
+                if (page_size == PageSize::huge_1gb && buffer_size < huge_page_1gb)
+                    continue;
+
+                const size_t mapped_size = (buffer_size + page_bytes - 1) & ~(page_bytes - 1);
+                void* buffer = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT), -1, 0);
+                if (buffer != MAP_FAILED)
+                {
+                    block.buffer = static_cast<UBYTE*>(buffer);
+                    block.mapped_size = mapped_size;
+                    block.page_size = page_size;
+                    break;
+                }
+            }
+        }
+
+        if (!block.buffer)
+        {
+            const size_t page_bytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            block.mapped_size = (buffer_size + page_bytes - 1) & ~(page_bytes - 1);
+            void* buffer = mmap(nullptr, block.mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (buffer == MAP_FAILED)
+            {
+                std::cout << "mmap failed to alloc " << buffer_size << " bytes (error = " << errno << ")" << std::endl;
+                return block;
+            }
+            block.buffer = static_cast<UBYTE*>(buffer);
+            if (_huge_pages_enabled)
+                madvise(block.buffer, block.mapped_size, MADV_HUGEPAGE);
+        }
+
+        if (_numa_node && *_numa_node < sizeof(unsigned long) * 8)
+        {
+            const unsigned long node_mask = 1ul << *_numa_node;
+            if (syscall(SYS_mbind, block.buffer, block.mapped_size, MPOL_BIND, &node_mask, sizeof(node_mask) * 8, 0) != 0)
+                std::cout << "WARNING: Could not bind frame buffer to NUMA node " << *_numa_node << " (error = " << errno << ")" << std::endl;
+        }
+
+        block.locked = (mlock(block.buffer, block.mapped_size) == 0);
+    #elif !defined(__APPLE__)
+        const DWORD numa_node = _numa_node ? static_cast<DWORD>(*_numa_node) : NUMA_NO_PREFERRED_NODE;
+        const SIZE_T large_page_bytes = GetLargePageMinimum();
+        if (_huge_pages_enabled && large_page_bytes > 0)
+        {
+            const SIZE_T mapped_size = (buffer_size + large_page_bytes - 1) & ~(large_page_bytes - 1);
+            block.buffer = static_cast<UBYTE*>(VirtualAllocExNuma(GetCurrentProcess(), NULL, mapped_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, numa_node));
+            if (block.buffer)
+            {
+                block.mapped_size = mapped_size;
+                block.page_size = (large_page_bytes >= (SIZE_T(1) << 30)) ? PageSize::huge_1gb : PageSize::huge_2mb;
+                block.locked = true;
+            }
+        }
+
+        if (!block.buffer)
+        {
+            block.buffer = static_cast<UBYTE*>(VirtualAllocExNuma(GetCurrentProcess(), NULL, buffer_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, numa_node));
+            if (!block.buffer)
+            {
+                std::cout << "VirtualAllocExNuma failed to alloc " << buffer_size << " bytes (error = " << GetLastError() << ")" << std::endl;
+                return block;
+            }
+            block.locked = VirtualLock(block.buffer, buffer_size);
+        }
+    #else
+        int error = posix_memalign((void**)&block.buffer, 4096, buffer_size);
+        if (error != 0)
+        {
+            std::cout << "posix_memalign failed to alloc " << buffer_size << " bytes (error = " << error << ")" << std::endl;
+            block.buffer = nullptr;
+            return block;
+        }
+    #endif
+
+        // Faults every page in now rather than during the first live frames
+        memset(block.buffer, 0, block.mapped_size);
+
+        return block;
+    }
+
+    void BufferPool::deallocate(const Block& block)
+    {
+        if (!block.buffer)
+            return;
+
+    #if defined(__linux__)
+        munmap(block.buffer, block.mapped_size);
+    #elif !defined(__APPLE__)
+        VirtualFree(block.buffer, 0, MEM_RELEASE);
+    #else
+        free(block.buffer);
+    #endif
+    }
+
+    void BufferPool::report(const Block& block)
+    {
+        if (_huge_pages_enabled && block.page_size == PageSize::regular && !_huge_page_fallback_reported)
+        {
+            std::cout << "WARNING: Huge pages are not available for frame buffers, falling back to regular pages" << std::endl;
+            _huge_page_fallback_reported = true;
+        }
+        if (!block.locked && !_locking_failure_reported)
+        {
+            std::cout << "WARNING: Frame buffers could not be locked in memory (check the locked memory limit)" << std::endl;
+            _locking_failure_reported = true;
+        }
+    }
 }
\ No newline at end of file
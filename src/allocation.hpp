@@ -15,6 +15,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
 #include "VideoMasterHD_Core.h"
 #include "VideoMasterHD_ApplicationBuffers.h"
 
@@ -22,4 +27,54 @@ namespace Application::Allocation
 {
     VHD_APPLICATION_BUFFER_DESCRIPTOR allocate_buffer(ULONG buffer_size);
     void deallocate_buffer(VHD_APPLICATION_BUFFER_DESCRIPTOR buffer_descriptor);
+
+    std::optional<unsigned int> numa_node_of_core(unsigned int core);
+
+    // Frame buffers backed by huge pages when available, bound to a NUMA node, pre-faulted and locked in memory when allocated.
+    // Released buffers are kept and handed out again, so that restarting the streams does not allocate nor fault any page.
+    class BufferPool
+    {
+    public:
+        BufferPool(bool huge_pages_enabled, std::optional<unsigned int> numa_node);
+        ~BufferPool();
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        // Throws std::bad_alloc when no buffer can be allocated
+        VHD_APPLICATION_BUFFER_DESCRIPTOR acquire(ULONG buffer_size);
+        void release(const VHD_APPLICATION_BUFFER_DESCRIPTOR& buffer_descriptor);
+        // Allocates buffers ahead of time so that they are handed out without allocating by the next acquisitions
+        void reserve(unsigned int number_of_buffers, ULONG buffer_size);
+
+    private:
+        enum class PageSize
+        {
+            regular,
+            huge_2mb,
+            huge_1gb,
+        };
+
+        struct Block
+        {
+            UBYTE* buffer;
+            size_t mapped_size;
+            ULONG buffer_size;
+            PageSize page_size;
+            bool locked;
+            bool in_use;
+        };
+
+        bool _huge_pages_enabled;
+        std::optional<unsigned int> _numa_node;
+
+        std::mutex _mutex;
+        std::vector<Block> _blocks;
+        bool _huge_page_fallback_reported = false;
+        bool _locking_failure_reported = false;
+
+        Block allocate(ULONG buffer_size);
+        void deallocate(const Block& block);
+        void report(const Block& block);
+    };
 }
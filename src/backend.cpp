@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "backend.hpp"
+
+#include <new>
+
+namespace Application::Backend
+{
+    ApplicationBuffers::ApplicationBuffers(Allocation::BufferPool& buffer_pool, unsigned int number_of_buffers, uint32_t buffer_size)
+        : _buffer_pool(buffer_pool)
+        , _references(std::make_unique<std::atomic<unsigned int>[]>(number_of_buffers))
+        , _buffer_size(buffer_size)
+    {
+        try
+        {
+            for (unsigned int i = 0; i < number_of_buffers; ++i)
+            {
+                _descriptors.push_back(_buffer_pool.acquire(buffer_size));
+                _references[i] = 0;
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            for (auto& descriptor : _descriptors)
+                _buffer_pool.release(descriptor);
+            throw;
+        }
+    }
+
+    ApplicationBuffers::~ApplicationBuffers()
+    {
+        for (auto& descriptor : _descriptors)
+            _buffer_pool.release(descriptor);
+    }
+
+    unsigned int ApplicationBuffers::size() const
+    {
+        return static_cast<unsigned int>(_descriptors.size());
+    }
+
+    uint32_t ApplicationBuffers::buffer_size() const
+    {
+        return _buffer_size;
+    }
+
+    uint8_t* ApplicationBuffers::buffer(unsigned int index)
+    {
+        return _descriptors[index].pBuffer;
+    }
+
+    VHD_APPLICATION_BUFFER_DESCRIPTOR& ApplicationBuffers::descriptor(unsigned int index)
+    {
+        return _descriptors[index];
+    }
+
+    std::optional<unsigned int> ApplicationBuffers::index_of(const uint8_t* buffer) const
+    {
+        for (unsigned int i = 0; i < _descriptors.size(); ++i)
+        {
+            if (_descriptors[i].pBuffer == buffer)
+                return i;
+        }
+        return std::nullopt;
+    }
+
+    void ApplicationBuffers::set_recycler(Recycler recycler)
+    {
+        _recycler = std::move(recycler);
+    }
+
+    void ApplicationBuffers::acquire(unsigned int index)
+    {
+        _references[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ApplicationBuffers::release(unsigned int index)
+    {
+        if (_references[index].fetch_sub(1, std::memory_order_acq_rel) == 1 && _recycler)
+            _recycler(index);
+    }
+
+    ApplicationBufferSlot::ApplicationBufferSlot(ApplicationBuffers& application_buffers, unsigned int index)
+        : _application_buffers(application_buffers)
+        , _index(index)
+    {
+        _application_buffers.acquire(_index);
+    }
+
+    ApplicationBufferSlot::~ApplicationBufferSlot()
+    {
+        _application_buffers.release(_index);
+    }
+
+    std::pair<uint8_t*, uint32_t> ApplicationBufferSlot::buffer()
+    {
+        return { _application_buffers.buffer(_index), _application_buffers.buffer_size() };
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "VideoMasterHD_ApplicationBuffers.h"
+
+#include "allocation.hpp"
+#include "helper.hpp"
+
+namespace Application::Backend
+{
+    class Slot
+    {
+    public:
+        virtual ~Slot() = default;
+
+        virtual std::pair<uint8_t*, uint32_t> buffer() = 0;
+    };
+
+    // Frame buffers allocated by the application and shared by the RX and TX streams, so that a captured buffer can be sent without copy.
+    // Each holder of a captured buffer keeps a reference on it, and the buffer is handed to the recycler once the last one is released.
+    class ApplicationBuffers
+    {
+    public:
+        using Recycler = std::function<void(unsigned int index)>;
+
+        ApplicationBuffers(Allocation::BufferPool& buffer_pool, unsigned int number_of_buffers, uint32_t buffer_size);
+        ~ApplicationBuffers();
+
+        ApplicationBuffers(const ApplicationBuffers&) = delete;
+        ApplicationBuffers& operator=(const ApplicationBuffers&) = delete;
+
+        unsigned int size() const;
+        uint32_t buffer_size() const;
+        uint8_t* buffer(unsigned int index);
+        VHD_APPLICATION_BUFFER_DESCRIPTOR& descriptor(unsigned int index);
+        std::optional<unsigned int> index_of(const uint8_t* buffer) const;
+
+        void set_recycler(Recycler recycler);
+        void acquire(unsigned int index);
+        void release(unsigned int index);
+
+    private:
+        Allocation::BufferPool& _buffer_pool;
+        std::vector<VHD_APPLICATION_BUFFER_DESCRIPTOR> _descriptors;
+        std::unique_ptr<std::atomic<unsigned int>[]> _references;
+        uint32_t _buffer_size;
+        Recycler _recycler;
+    };
+
+    class ApplicationBufferSlot : public Slot
+    {
+    public:
+        ApplicationBufferSlot(ApplicationBuffers& application_buffers, unsigned int index);
+        ~ApplicationBufferSlot() override;
+
+        std::pair<uint8_t*, uint32_t> buffer() override;
+
+    private:
+        ApplicationBuffers& _application_buffers;
+        unsigned int _index;
+    };
+
+    class Stream
+    {
+    public:
+        virtual ~Stream() = default;
+
+        virtual void start() = 0;
+        // Stops a started stream so that it can be configured again, once all its slots have been released
+        virtual void stop() = 0;
+        // Returns nullptr when no slot became available before the stream timeout
+        virtual std::unique_ptr<Slot> pop_slot() = 0;
+
+        virtual unsigned int filling() = 0;
+        virtual unsigned int slots_count() = 0;
+        virtual unsigned int slots_dropped() = 0;
+
+        virtual bool signal_present() = 0;
+        virtual Helper::SignalInformation detect_information() = 0;
+
+        // Makes the stream carry the application buffers instead of its own slots, before it is started.
+        // An RX stream captures into every buffer that is not referenced and pop_slot returns them once filled.
+        virtual void attach_application_buffers(ApplicationBuffers& application_buffers) = 0;
+        // TX only: queues a referenced application buffer for sending, then releases it once sent
+        virtual void send_application_buffer(unsigned int index) = 0;
+        virtual void collect_sent_application_buffers() = 0;
+    };
+
+    class Device
+    {
+    public:
+        virtual ~Device() = default;
+
+        virtual std::unique_ptr<Stream> open_rx_stream() = 0;
+        virtual std::unique_ptr<Stream> open_tx_stream() = 0;
+        // Return the layout of the frames carried by the configured stream, in a pixel format that has a VideoMaster packing
+        virtual Processing::FrameDescriptor configure_rx_stream(Stream& rx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format) = 0;
+        virtual Processing::FrameDescriptor configure_tx_stream(Stream& tx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format) = 0;
+
+        virtual bool has_genlock() = 0;
+        virtual void configure_genlock(const Helper::SignalInformation& signal_information) = 0;
+        virtual bool genlock_locked() = 0;
+
+        virtual void configure_keyer() = 0;
+        virtual void disable_keyer() = 0;
+
+        virtual void enable_loopback() = 0;
+        virtual void disable_loopback() = 0;
+    };
+}
@@ -0,0 +1,424 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "kernels.hpp"
+#include "pixel_format.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CONVERSIONS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CONVERSIONS_TARGET(instruction_sets)
+#else
+#define CONVERSIONS_TARGET(instruction_sets) __attribute__((target(instruction_sets)))
+#endif
+
+// Pixel conversions between the packings carried by the streams, specialized at compile time for each (source, destination) pair
+namespace Application::Conversions
+{
+    using Processing::PixelFormat;
+
+    // Converts a run of pixels starting on a pixel group boundary
+    using ConvertLine = void (*)(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels);
+
+    namespace Detail
+    {
+        // BT.709 limited range to 8-bit RGB in Q8 coefficients. Terms are rounded as _mm_mulhrs_epi16 does on samples scaled to Q7,
+        // so that the scalar and vectorized paths produce the same bytes.
+        constexpr int16_t luma_coefficient = 298;
+        constexpr int16_t red_from_v = 459;
+        constexpr int16_t green_from_u = 55;
+        constexpr int16_t green_from_v = 136;
+        constexpr int16_t blue_from_u = 541;
+
+        constexpr int32_t multiply_high_rounded(int32_t a, int32_t b) { return (a * b + 0x4000) >> 15; }
+        constexpr uint8_t saturate(int32_t value) { return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value)); }
+
+        template <PixelFormat Destination>
+        inline void store(uint8_t* destination, uint8_t blue, uint8_t green, uint8_t red)
+        {
+            static_assert(Destination == PixelFormat::rgb_24 || Destination == PixelFormat::rgba_32, "YUV and 10-bit RGB decode to 8-bit RGB only");
+            destination[0] = blue;
+            destination[1] = green;
+            destination[2] = red;
+            if constexpr (Destination == PixelFormat::rgba_32)
+                destination[3] = 0xFF;
+        }
+
+        // Luma and chroma have their offset removed and are scaled so that an 8-bit step is 128
+        template <PixelFormat Destination>
+        inline void store_yuv(uint8_t* destination, int32_t y, int32_t u, int32_t v)
+        {
+            const int32_t luma = multiply_high_rounded(y, luma_coefficient);
+            store<Destination>(destination,
+                               saturate(luma + multiply_high_rounded(u, blue_from_u)),
+                               saturate(luma - multiply_high_rounded(u, green_from_u) - multiply_high_rounded(v, green_from_v)),
+                               saturate(luma + multiply_high_rounded(v, red_from_v)));
+        }
+
+        // 8-bit RGB to BT.709 limited range 10-bit YUV
+        inline void encode_yuv(const uint8_t* source, int32_t& y, int32_t& u, int32_t& v)
+        {
+            const int32_t blue = source[0], green = source[1], red = source[2];
+            y = 64 + ((187 * red + 629 * green + 63 * blue + 128) >> 8);
+            u = 512 + ((-103 * red - 347 * green + 450 * blue + 128) >> 8);
+            v = 512 + ((450 * red - 408 * green - 42 * blue + 128) >> 8);
+        }
+
+        // Two horizontally adjacent pixels share the average of their chroma
+        inline void encode_yuv_pair(const uint8_t* first, const uint8_t* second, int32_t& first_y, int32_t& second_y, int32_t& u, int32_t& v)
+        {
+            int32_t first_u, first_v, second_u, second_v;
+            encode_yuv(first, first_y, first_u, first_v);
+            encode_yuv(second, second_y, second_u, second_v);
+            u = (first_u + second_u + 1) >> 1;
+            v = (first_v + second_v + 1) >> 1;
+        }
+
+    #ifdef CONVERSIONS_X86
+        // Same arithmetic as store_yuv on 8 pixels, interleaved into 8 BGRA pixels
+        CONVERSIONS_TARGET("ssse3")
+        inline void yuv_to_bgra_ssse3(__m128i y, __m128i u, __m128i v, __m128i& low_pixels, __m128i& high_pixels)
+        {
+            const __m128i luma = _mm_mulhrs_epi16(y, _mm_set1_epi16(luma_coefficient));
+            const __m128i blue = _mm_add_epi16(luma, _mm_mulhrs_epi16(u, _mm_set1_epi16(blue_from_u)));
+            const __m128i green = _mm_sub_epi16(_mm_sub_epi16(luma, _mm_mulhrs_epi16(u, _mm_set1_epi16(green_from_u))),
+                                                _mm_mulhrs_epi16(v, _mm_set1_epi16(green_from_v)));
+            const __m128i red = _mm_add_epi16(luma, _mm_mulhrs_epi16(v, _mm_set1_epi16(red_from_v)));
+
+            const __m128i blue_green = _mm_unpacklo_epi8(_mm_packus_epi16(blue, blue), _mm_packus_epi16(green, green));
+            const __m128i red_alpha = _mm_unpacklo_epi8(_mm_packus_epi16(red, red), _mm_set1_epi8(-1));
+            low_pixels = _mm_unpacklo_epi16(blue_green, red_alpha);
+            high_pixels = _mm_unpackhi_epi16(blue_green, red_alpha);
+        }
+    #endif
+
+        inline uint32_t load_word(const uint8_t* source)
+        {
+            uint32_t word;
+            memcpy(&word, source, sizeof(word));
+            return word;
+        }
+
+        inline void store_word(uint8_t* destination, uint32_t word)
+        {
+            memcpy(destination, &word, sizeof(word));
+        }
+    }
+
+    template <PixelFormat Format>
+    struct Copy
+    {
+        static void convert(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            memcpy(destination, source, Processing::line_size(Format, number_of_pixels));
+        }
+
+        static ConvertLine select(Kernels::InstructionSet) { return &convert; }
+    };
+
+    template <PixelFormat Source, PixelFormat Destination>
+    struct Conversion;
+
+    template <>
+    struct Conversion<PixelFormat::rgb_24, PixelFormat::rgba_32>
+    {
+        static ConvertLine select(Kernels::InstructionSet instruction_set) { return Kernels::select_rgb_24_to_rgba_32(instruction_set); }
+    };
+
+    template <PixelFormat Destination>
+    struct Conversion<PixelFormat::yuv_422_8, Destination>
+    {
+        static void convert(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            constexpr uint32_t pixel_size = Processing::pixel_group(Destination).bytes;
+            for (uint32_t i = 0; i < number_of_pixels; i += 2, source += 4)
+            {
+                const int32_t u = (source[0] - 128) * 128;
+                const int32_t v = (source[2] - 128) * 128;
+                Detail::store_yuv<Destination>(destination + i * pixel_size, (source[1] - 16) * 128, u, v);
+                if (i + 1 < number_of_pixels)
+                    Detail::store_yuv<Destination>(destination + (i + 1) * pixel_size, (source[3] - 16) * 128, u, v);
+            }
+        }
+
+    #ifdef CONVERSIONS_X86
+        CONVERSIONS_TARGET("ssse3")
+        static void convert_ssse3(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            const __m128i u_shuffle = _mm_setr_epi8(0, -1, 0, -1, 4, -1, 4, -1, 8, -1, 8, -1, 12, -1, 12, -1);
+            const __m128i v_shuffle = _mm_setr_epi8(2, -1, 2, -1, 6, -1, 6, -1, 10, -1, 10, -1, 14, -1, 14, -1);
+            const __m128i luma_offset = _mm_set1_epi16(16);
+            const __m128i chroma_offset = _mm_set1_epi16(128);
+
+            uint32_t i = 0;
+            for (; i + 8 <= number_of_pixels; i += 8)
+            {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+                const __m128i y = _mm_slli_epi16(_mm_sub_epi16(_mm_srli_epi16(pixels, 8), luma_offset), 7);
+                const __m128i u = _mm_slli_epi16(_mm_sub_epi16(_mm_shuffle_epi8(pixels, u_shuffle), chroma_offset), 7);
+                const __m128i v = _mm_slli_epi16(_mm_sub_epi16(_mm_shuffle_epi8(pixels, v_shuffle), chroma_offset), 7);
+
+                __m128i low_pixels, high_pixels;
+                Detail::yuv_to_bgra_ssse3(y, u, v, low_pixels, high_pixels);
+                __m128i* output = reinterpret_cast<__m128i*>(destination + i * 4);
+                _mm_storeu_si128(output + 0, low_pixels);
+                _mm_storeu_si128(output + 1, high_pixels);
+            }
+
+            convert(source + i * 2, destination + i * 4, number_of_pixels - i);
+        }
+    #endif
+
+        static ConvertLine select(Kernels::InstructionSet instruction_set)
+        {
+        #ifdef CONVERSIONS_X86
+            if constexpr (Destination == PixelFormat::rgba_32)
+                if (instruction_set >= Kernels::InstructionSet::ssse3)
+                    return &convert_ssse3;
+        #endif
+            (void)instruction_set;
+            return &convert;
+        }
+    };
+
+    template <PixelFormat Destination>
+    struct Conversion<PixelFormat::yuv_422_10, Destination>
+    {
+        static void convert(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            constexpr uint32_t pixel_size = Processing::pixel_group(Destination).bytes;
+            for (uint32_t i = 0; i < number_of_pixels; i += 6, source += 16)
+            {
+                const uint32_t words[4] = { Detail::load_word(source), Detail::load_word(source + 4), Detail::load_word(source + 8), Detail::load_word(source + 12) };
+                const uint32_t y[6] = { (words[0] >> 10) & 0x3FF, words[1] & 0x3FF, (words[1] >> 20) & 0x3FF,
+                                        (words[2] >> 10) & 0x3FF, words[3] & 0x3FF, (words[3] >> 20) & 0x3FF };
+                const uint32_t u[3] = { words[0] & 0x3FF, (words[1] >> 10) & 0x3FF, (words[2] >> 20) & 0x3FF };
+                const uint32_t v[3] = { (words[0] >> 20) & 0x3FF, words[2] & 0x3FF, (words[3] >> 10) & 0x3FF };
+
+                for (uint32_t pixel = 0; pixel < 6 && i + pixel < number_of_pixels; ++pixel)
+                    Detail::store_yuv<Destination>(destination + (i + pixel) * pixel_size, (static_cast<int32_t>(y[pixel]) - 64) * 32,
+                                                   (static_cast<int32_t>(u[pixel / 2]) - 512) * 32, (static_cast<int32_t>(v[pixel / 2]) - 512) * 32);
+            }
+        }
+
+    #ifdef CONVERSIONS_X86
+        // One V210 group per iteration: the three 10-bit fields of the four words are gathered into 16-bit luma and chroma lanes,
+        // the last two lanes being unused
+        CONVERSIONS_TARGET("ssse3")
+        static void convert_ssse3(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            const __m128i field_mask = _mm_set1_epi32(0x3FF);
+            const __m128i y_from_first = _mm_setr_epi8(8, 9, 2, 3, -1, -1, 12, 13, 6, 7, -1, -1, -1, -1, -1, -1);
+            const __m128i y_from_third = _mm_setr_epi8(-1, -1, -1, -1, 2, 3, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1);
+            const __m128i u_from_first = _mm_setr_epi8(0, 1, 0, 1, 10, 11, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m128i u_from_third = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 4, 5, 4, 5, -1, -1, -1, -1);
+            const __m128i v_from_first = _mm_setr_epi8(-1, -1, -1, -1, 4, 5, 4, 5, 14, 15, 14, 15, -1, -1, -1, -1);
+            const __m128i v_from_third = _mm_setr_epi8(0, 1, 0, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m128i luma_offset = _mm_set1_epi16(64);
+            const __m128i chroma_offset = _mm_set1_epi16(512);
+
+            uint32_t i = 0;
+            for (; i + 6 <= number_of_pixels; i += 6, source += 16)
+            {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+                // First fields then second fields: U0 Y1 V1 Y4 Y0 U1 Y3 V2, and third fields: V0 Y2 U2 Y5
+                const __m128i first_fields = _mm_packs_epi32(_mm_and_si128(words, field_mask), _mm_and_si128(_mm_srli_epi32(words, 10), field_mask));
+                const __m128i third_fields = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(words, 20), field_mask), _mm_setzero_si128());
+
+                const __m128i y = _mm_or_si128(_mm_shuffle_epi8(first_fields, y_from_first), _mm_shuffle_epi8(third_fields, y_from_third));
+                const __m128i u = _mm_or_si128(_mm_shuffle_epi8(first_fields, u_from_first), _mm_shuffle_epi8(third_fields, u_from_third));
+                const __m128i v = _mm_or_si128(_mm_shuffle_epi8(first_fields, v_from_first), _mm_shuffle_epi8(third_fields, v_from_third));
+
+                __m128i low_pixels, high_pixels;
+                Detail::yuv_to_bgra_ssse3(_mm_slli_epi16(_mm_sub_epi16(y, luma_offset), 5), _mm_slli_epi16(_mm_sub_epi16(u, chroma_offset), 5),
+                                          _mm_slli_epi16(_mm_sub_epi16(v, chroma_offset), 5), low_pixels, high_pixels);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), low_pixels);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i * 4 + 16), high_pixels);
+            }
+
+            convert(source, destination + i * 4, number_of_pixels - i);
+        }
+    #endif
+
+        static ConvertLine select(Kernels::InstructionSet instruction_set)
+        {
+        #ifdef CONVERSIONS_X86
+            if constexpr (Destination == PixelFormat::rgba_32)
+                if (instruction_set >= Kernels::InstructionSet::ssse3)
+                    return &convert_ssse3;
+        #endif
+            (void)instruction_set;
+            return &convert;
+        }
+    };
+
+    template <PixelFormat Destination>
+    struct Conversion<PixelFormat::rgb_30, Destination>
+    {
+        static void convert(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            constexpr uint32_t pixel_size = Processing::pixel_group(Destination).bytes;
+            for (uint32_t i = 0; i < number_of_pixels; ++i)
+            {
+                const uint32_t word = Detail::load_word(source + i * 4);
+                Detail::store<Destination>(destination + i * pixel_size, static_cast<uint8_t>(word >> 2), static_cast<uint8_t>(word >> 12), static_cast<uint8_t>(word >> 22));
+            }
+        }
+
+    #ifdef CONVERSIONS_X86
+        CONVERSIONS_TARGET("ssse3")
+        static void convert_ssse3(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            const __m128i blue_mask = _mm_set1_epi32(0x000000FF);
+            const __m128i green_mask = _mm_set1_epi32(0x0000FF00);
+            const __m128i red_mask = _mm_set1_epi32(0x00FF0000);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+            uint32_t i = 0;
+            for (; i + 4 <= number_of_pixels; i += 4)
+            {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+                const __m128i blue = _mm_and_si128(_mm_srli_epi32(words, 2), blue_mask);
+                const __m128i green = _mm_and_si128(_mm_srli_epi32(words, 4), green_mask);
+                const __m128i red = _mm_and_si128(_mm_srli_epi32(words, 6), red_mask);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_or_si128(_mm_or_si128(blue, green), _mm_or_si128(red, alpha)));
+            }
+
+            convert(source + i * 4, destination + i * 4, number_of_pixels - i);
+        }
+    #endif
+
+        static ConvertLine select(Kernels::InstructionSet instruction_set)
+        {
+        #ifdef CONVERSIONS_X86
+            if constexpr (Destination == PixelFormat::rgba_32)
+                if (instruction_set >= Kernels::InstructionSet::ssse3)
+                    return &convert_ssse3;
+        #endif
+            (void)instruction_set;
+            return &convert;
+        }
+    };
+
+    // Encodes 8-bit RGB into the capture packings, which the simulated streams use to generate their content
+    template <PixelFormat Destination>
+    struct Conversion<PixelFormat::rgb_24, Destination>
+    {
+        static void convert(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            if constexpr (Destination == PixelFormat::rgb_30)
+            {
+                for (uint32_t i = 0; i < number_of_pixels; ++i, source += 3)
+                {
+                    const auto expand = [](uint32_t component) { return (component << 2) | (component >> 6); };
+                    Detail::store_word(destination + i * 4, (expand(source[2]) << 20) | (expand(source[1]) << 10) | expand(source[0]));
+                }
+            }
+            else if constexpr (Destination == PixelFormat::yuv_422_8)
+            {
+                for (uint32_t i = 0; i < number_of_pixels; i += 2, source += 6, destination += 4)
+                {
+                    // A missing last pixel repeats the previous one
+                    int32_t y[2], u, v;
+                    Detail::encode_yuv_pair(source, (i + 1 < number_of_pixels) ? source + 3 : source, y[0], y[1], u, v);
+                    const auto to_8_bit = [](int32_t sample) { return static_cast<uint8_t>(std::min((sample + 2) >> 2, 255)); };
+                    destination[0] = to_8_bit(u);
+                    destination[1] = to_8_bit(y[0]);
+                    destination[2] = to_8_bit(v);
+                    destination[3] = to_8_bit(y[1]);
+                }
+            }
+            else
+            {
+                static_assert(Destination == PixelFormat::yuv_422_10, "8-bit RGB encodes to the capture packings only");
+                for (uint32_t i = 0; i < number_of_pixels; i += 6, destination += 16)
+                {
+                    // Pixels past the end repeat the last one
+                    int32_t y[6], u[3], v[3];
+                    for (uint32_t pair = 0; pair < 3; ++pair)
+                        Detail::encode_yuv_pair(source + 3 * std::min(i + 2 * pair, number_of_pixels - 1), source + 3 * std::min(i + 2 * pair + 1, number_of_pixels - 1),
+                                                y[2 * pair], y[2 * pair + 1], u[pair], v[pair]);
+
+                    Detail::store_word(destination + 0, u[0] | (y[0] << 10) | (v[0] << 20));
+                    Detail::store_word(destination + 4, y[1] | (u[1] << 10) | (y[2] << 20));
+                    Detail::store_word(destination + 8, v[1] | (y[3] << 10) | (u[2] << 20));
+                    Detail::store_word(destination + 12, y[4] | (v[2] << 10) | (y[5] << 20));
+                }
+            }
+        }
+
+        static ConvertLine select(Kernels::InstructionSet) { return &convert; }
+    };
+
+    struct ConversionEntry
+    {
+        PixelFormat source;
+        PixelFormat destination;
+        ConvertLine (*select)(Kernels::InstructionSet instruction_set);
+    };
+
+    template <PixelFormat Source, PixelFormat Destination>
+    constexpr ConversionEntry entry()
+    {
+        if constexpr (Source == Destination)
+            return { Source, Destination, &Copy<Source>::select };
+        else
+            return { Source, Destination, &Conversion<Source, Destination>::select };
+    }
+
+    inline constexpr ConversionEntry conversions[] = {
+        entry<PixelFormat::rgb_24, PixelFormat::rgb_24>(),
+        entry<PixelFormat::rgba_32, PixelFormat::rgba_32>(),
+        entry<PixelFormat::yuv_422_8, PixelFormat::yuv_422_8>(),
+        entry<PixelFormat::yuv_422_10, PixelFormat::yuv_422_10>(),
+        entry<PixelFormat::rgb_30, PixelFormat::rgb_30>(),
+
+        entry<PixelFormat::rgb_24, PixelFormat::rgba_32>(),
+        entry<PixelFormat::yuv_422_8, PixelFormat::rgba_32>(),
+        entry<PixelFormat::yuv_422_8, PixelFormat::rgb_24>(),
+        entry<PixelFormat::yuv_422_10, PixelFormat::rgba_32>(),
+        entry<PixelFormat::yuv_422_10, PixelFormat::rgb_24>(),
+        entry<PixelFormat::rgb_30, PixelFormat::rgba_32>(),
+        entry<PixelFormat::rgb_30, PixelFormat::rgb_24>(),
+
+        entry<PixelFormat::rgb_24, PixelFormat::yuv_422_8>(),
+        entry<PixelFormat::rgb_24, PixelFormat::yuv_422_10>(),
+        entry<PixelFormat::rgb_24, PixelFormat::rgb_30>(),
+    };
+
+    // Returns nullptr when the pair is not supported
+    inline ConvertLine find_conversion(PixelFormat source, PixelFormat destination, Kernels::InstructionSet instruction_set)
+    {
+        for (const ConversionEntry& conversion : conversions)
+            if (conversion.source == source && conversion.destination == destination)
+                return conversion.select(instruction_set);
+        return nullptr;
+    }
+
+    inline ConvertLine find_conversion(PixelFormat source, PixelFormat destination)
+    {
+        static const Kernels::InstructionSet instruction_set = Kernels::detect_instruction_set();
+        return find_conversion(source, destination, instruction_set);
+    }
+}
@@ -0,0 +1,303 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hardware_backend.hpp"
+#include "logger.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include <VideoMasterCppApi/exception.hpp>
+
+using namespace Deltacast::Wrapper;
+
+namespace
+{
+    const ULONG application_buffer_timeout_ms = 100;
+}
+
+namespace Application::Backend
+{
+    HardwareSlot::HardwareSlot(std::unique_ptr<Deltacast::Wrapper::Slot> slot)
+        : _slot(std::move(slot))
+    {
+    }
+
+    std::pair<uint8_t*, uint32_t> HardwareSlot::buffer()
+    {
+        auto& [ buffer, buffer_size ] = _slot->video().buffer();
+        return { buffer, buffer_size };
+    }
+
+    HardwareStream::HardwareStream(Helper::TechStream tech_stream, BoardComponents::RxConnector* rx_connector, const char* log_prefix)
+        : _tech_stream(std::move(tech_stream))
+        , _rx_connector(rx_connector)
+        , _log_prefix(log_prefix)
+    {
+    }
+
+    void HardwareStream::start()
+    {
+        Helper::to_base_stream(_tech_stream).start();
+
+        if (_application_buffers && _rx_connector)
+        {
+            for (unsigned int i = 0; i < _application_buffers->size(); ++i)
+                queue_application_buffer(i);
+        }
+    }
+
+    void HardwareStream::stop()
+    {
+        Helper::to_base_stream(_tech_stream).stop();
+    }
+
+    std::unique_ptr<Slot> HardwareStream::pop_slot()
+    {
+        if (_application_buffers)
+        {
+            HANDLE slot_handle = nullptr;
+            const ULONG result = VHD_WaitSlotFilled(Helper::to_base_stream(_tech_stream).handle(), &slot_handle, application_buffer_timeout_ms);
+            if (result != VHDERR_NOERROR)
+            {
+                if (result != VHDERR_TIMEOUT)
+                    Logging::log(Logging::Event::api_error, _log_prefix, "VHD_WaitSlotFilled", result);
+                return nullptr;
+            }
+            return std::make_unique<ApplicationBufferSlot>(*_application_buffers, _application_slot_indexes.at(slot_handle));
+        }
+
+        try { return std::make_unique<HardwareSlot>(Helper::to_base_stream(_tech_stream).pop_slot()); }
+        catch (const ApiException& e)
+        {
+            if (e.error_code() != VHDERR_TIMEOUT)
+                throw;
+
+            return nullptr;
+        }
+    }
+
+    unsigned int HardwareStream::filling()
+    {
+        return Helper::to_base_stream(_tech_stream).buffer_queue().filling();
+    }
+
+    unsigned int HardwareStream::slots_count()
+    {
+        return Helper::to_base_stream(_tech_stream).buffer_queue().slots_count();
+    }
+
+    unsigned int HardwareStream::slots_dropped()
+    {
+        return Helper::to_base_stream(_tech_stream).buffer_queue().slots_dropped();
+    }
+
+    bool HardwareStream::signal_present()
+    {
+        return _rx_connector && _rx_connector->signal_present();
+    }
+
+    Helper::SignalInformation HardwareStream::detect_information()
+    {
+        return Helper::detect_information(_tech_stream);
+    }
+
+    void HardwareStream::attach_application_buffers(ApplicationBuffers& application_buffers)
+    {
+        _application_buffers = &application_buffers;
+        _application_slots.assign(application_buffers.size(), nullptr);
+        _application_slot_indexes.clear();
+
+        if (_rx_connector)
+            application_buffers.set_recycler([this](unsigned int index) { queue_application_buffer(index); });
+    }
+
+    void HardwareStream::send_application_buffer(unsigned int index)
+    {
+        _application_buffers->acquire(index);
+
+        const ULONG result = VHD_QueueOutSlot(application_slot(index));
+        if (result != VHDERR_NOERROR)
+        {
+            Logging::log(Logging::Event::api_error, _log_prefix, "VHD_QueueOutSlot", result);
+            _application_buffers->release(index);
+        }
+    }
+
+    void HardwareStream::collect_sent_application_buffers()
+    {
+        HANDLE slot_handle = nullptr;
+        while (VHD_WaitSlotSent(Helper::to_base_stream(_tech_stream).handle(), &slot_handle, 0) == VHDERR_NOERROR)
+            _application_buffers->release(_application_slot_indexes.at(slot_handle));
+    }
+
+    Helper::TechStream& HardwareStream::tech_stream()
+    {
+        return _tech_stream;
+    }
+
+    HANDLE HardwareStream::application_slot(unsigned int index)
+    {
+        if (!_application_slots[index])
+        {
+            std::vector<VHD_APPLICATION_BUFFER_DESCRIPTOR*> buffer_descriptors(Helper::number_of_buffer_types(_tech_stream), nullptr);
+            // The video buffer type comes first for both SDI and DV streams
+            buffer_descriptors[0] = &_application_buffers->descriptor(index);
+
+            const ULONG result = VHD_CreateSlotEx(Helper::to_base_stream(_tech_stream).handle(), buffer_descriptors.data(), &_application_slots[index]);
+            if (result != VHDERR_NOERROR)
+                Logging::log(Logging::Event::api_error, _log_prefix, "VHD_CreateSlotEx", result);
+            _application_slot_indexes[_application_slots[index]] = index;
+        }
+        return _application_slots[index];
+    }
+
+    void HardwareStream::queue_application_buffer(unsigned int index)
+    {
+        const ULONG result = VHD_QueueInSlot(application_slot(index));
+        if (result != VHDERR_NOERROR)
+            Logging::log(Logging::Event::api_error, _log_prefix, "VHD_QueueInSlot", result);
+    }
+
+    BoardGenlock::BoardGenlock(std::shared_ptr<Board> board)
+        : _board(std::move(board))
+    {
+    }
+
+    bool BoardGenlock::claim(unsigned int rx_stream_id)
+    {
+        std::lock_guard lock(_mutex);
+        if (_rx_stream_id && *_rx_stream_id != rx_stream_id)
+            return false;
+
+        _rx_stream_id = rx_stream_id;
+        return true;
+    }
+
+    std::optional<unsigned int> BoardGenlock::source() const
+    {
+        std::lock_guard lock(_mutex);
+        return _rx_stream_id;
+    }
+
+    void BoardGenlock::configure(unsigned int rx_stream_id, const Helper::SdiSignalInformation& signal_information)
+    {
+        std::lock_guard lock(_mutex);
+        if (_rx_stream_id != rx_stream_id)
+            throw std::logic_error("The genlock is not claimed for RX" + std::to_string(rx_stream_id));
+
+        auto& genlock = _board->sdi().genlock(0);
+        genlock.set_source(Helper::rx_to_genlock_source(rx_stream_id));
+        genlock.set_clock_divisor(signal_information.clock_divisor);
+        genlock.set_video_standard(signal_information.video_standard);
+    }
+
+    bool BoardGenlock::locked()
+    {
+        std::lock_guard lock(_mutex);
+        return _board->sdi().genlock(0).locked();
+    }
+
+    HardwareDevice::HardwareDevice(std::shared_ptr<Board> board, std::shared_ptr<BoardGenlock> genlock, unsigned int rx_stream_id, unsigned int tx_stream_id, const char* log_prefix)
+        : _board(std::move(board))
+        , _genlock(std::move(genlock))
+        , _rx_stream_id(rx_stream_id)
+        , _tx_stream_id(tx_stream_id)
+        , _log_prefix(log_prefix)
+    {
+    }
+
+    std::unique_ptr<Stream> HardwareDevice::open_rx_stream()
+    {
+        return std::make_unique<HardwareStream>(Helper::open_stream(*_board, Helper::rx_index_to_streamtype(_rx_stream_id)), &_board->rx(_rx_stream_id), _log_prefix);
+    }
+
+    std::unique_ptr<Stream> HardwareDevice::open_tx_stream()
+    {
+        return std::make_unique<HardwareStream>(Helper::open_stream(*_board, Helper::tx_index_to_streamtype(_tx_stream_id)), nullptr, _log_prefix);
+    }
+
+    Processing::FrameDescriptor HardwareDevice::configure_rx_stream(Stream& rx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format)
+    {
+        auto& rx_tech_stream = static_cast<HardwareStream&>(rx_stream).tech_stream();
+        auto& rx_base_stream = Helper::to_base_stream(rx_tech_stream);
+
+        const VHD_BUFFERPACKING buffer_packing = Helper::to_buffer_packing(pixel_format).value();
+        rx_base_stream.buffer_queue().set_transfer_scheme(VHD_TRANSFER_UNCONSTRAINED);
+        rx_base_stream.set_buffer_packing(buffer_packing);
+        Helper::configure_stream(rx_tech_stream, signal_information);
+
+        return Helper::get_frame_descriptor(signal_information, buffer_packing);
+    }
+
+    Processing::FrameDescriptor HardwareDevice::configure_tx_stream(Stream& tx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format)
+    {
+        auto& tx_tech_stream = static_cast<HardwareStream&>(tx_stream).tech_stream();
+        auto& tx_base_stream = Helper::to_base_stream(tx_tech_stream);
+
+        const VHD_BUFFERPACKING buffer_packing = Helper::to_buffer_packing(pixel_format).value();
+        tx_base_stream.buffer_queue().set_preload(0);
+        tx_base_stream.set_buffer_packing(buffer_packing);
+        if (std::holds_alternative<SdiStream>(tx_tech_stream))
+            std::get<SdiStream>(tx_tech_stream).genlock().enable();
+        Helper::configure_stream(tx_tech_stream, signal_information);
+
+        return Helper::get_frame_descriptor(signal_information, buffer_packing);
+    }
+
+    bool HardwareDevice::has_genlock()
+    {
+        return _board->has_sdi() && _board->rx(_rx_stream_id).has_sdi();
+    }
+
+    void HardwareDevice::configure_genlock(const Helper::SignalInformation& signal_information)
+    {
+        _genlock->configure(_rx_stream_id, std::get<Helper::SdiSignalInformation>(signal_information));
+    }
+
+    bool HardwareDevice::genlock_locked()
+    {
+        return _genlock->locked();
+    }
+
+    void HardwareDevice::configure_keyer()
+    {
+        auto& keyer = _board->keyer(_tx_stream_id);
+
+        keyer.set_input_a(Helper::rx_to_keyer_input(_rx_stream_id));
+        keyer.set_input_b(Helper::tx_to_keyer_input(_tx_stream_id));
+        keyer.set_input_k(Helper::tx_to_keyer_input(_tx_stream_id));
+        keyer.set_video_output(VHD_KOUTPUT_KEYER);
+        keyer.set_alpha_clip_min_value(0);
+        keyer.set_alpha_clip_max_value(1020);
+        keyer.set_alpha_blend_factor(1023);
+        keyer.enable();
+    }
+
+    void HardwareDevice::disable_keyer()
+    {
+        _board->keyer(_tx_stream_id).disable();
+    }
+
+    void HardwareDevice::enable_loopback()
+    {
+        Helper::enable_loopback(*_board, _rx_stream_id);
+    }
+
+    void HardwareDevice::disable_loopback()
+    {
+        Helper::disable_loopback(*_board, _tx_stream_id);
+    }
+}
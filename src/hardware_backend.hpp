@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <VideoMasterCppApi/board/board.hpp>
+
+#include "backend.hpp"
+
+namespace Application::Backend
+{
+    class HardwareSlot : public Slot
+    {
+    public:
+        explicit HardwareSlot(std::unique_ptr<Deltacast::Wrapper::Slot> slot);
+
+        std::pair<uint8_t*, uint32_t> buffer() override;
+
+    private:
+        std::unique_ptr<Deltacast::Wrapper::Slot> _slot;
+    };
+
+    class HardwareStream : public Stream
+    {
+    public:
+        // The log prefix of the channel must outlive the logging thread
+        HardwareStream(Helper::TechStream tech_stream, Deltacast::Wrapper::BoardComponents::RxConnector* rx_connector, const char* log_prefix);
+
+        void start() override;
+        void stop() override;
+        std::unique_ptr<Slot> pop_slot() override;
+
+        unsigned int filling() override;
+        unsigned int slots_count() override;
+        unsigned int slots_dropped() override;
+
+        bool signal_present() override;
+        Helper::SignalInformation detect_information() override;
+
+        void attach_application_buffers(ApplicationBuffers& application_buffers) override;
+        void send_application_buffer(unsigned int index) override;
+        void collect_sent_application_buffers() override;
+
+        Helper::TechStream& tech_stream();
+
+    private:
+        Helper::TechStream _tech_stream;
+        Deltacast::Wrapper::BoardComponents::RxConnector* _rx_connector;
+        const char* _log_prefix;
+
+        ApplicationBuffers* _application_buffers = nullptr;
+        std::vector<HANDLE> _application_slots;
+        std::unordered_map<HANDLE, unsigned int> _application_slot_indexes;
+
+        HANDLE application_slot(unsigned int index);
+        void queue_application_buffer(unsigned int index);
+    };
+
+    // The genlock of a board locks all its outputs to a single input, so it is claimed by the one channel genlocked to its input
+    class BoardGenlock
+    {
+    public:
+        explicit BoardGenlock(std::shared_ptr<Deltacast::Wrapper::Board> board);
+
+        // Returns false if the genlock is already claimed for another input
+        bool claim(unsigned int rx_stream_id);
+        std::optional<unsigned int> source() const;
+
+        void configure(unsigned int rx_stream_id, const Helper::SdiSignalInformation& signal_information);
+        bool locked();
+
+    private:
+        std::shared_ptr<Deltacast::Wrapper::Board> _board;
+        mutable std::mutex _mutex;
+        std::optional<unsigned int> _rx_stream_id;
+    };
+
+    class HardwareDevice : public Device
+    {
+    public:
+        // The board and its genlock are shared by the devices of every channel using one of its connector pairs
+        // The log prefix of the channel must outlive the logging thread
+        HardwareDevice(std::shared_ptr<Deltacast::Wrapper::Board> board, std::shared_ptr<BoardGenlock> genlock, unsigned int rx_stream_id, unsigned int tx_stream_id, const char* log_prefix);
+
+        std::unique_ptr<Stream> open_rx_stream() override;
+        std::unique_ptr<Stream> open_tx_stream() override;
+        Processing::FrameDescriptor configure_rx_stream(Stream& rx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format) override;
+        Processing::FrameDescriptor configure_tx_stream(Stream& tx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format) override;
+
+        bool has_genlock() override;
+        void configure_genlock(const Helper::SignalInformation& signal_information) override;
+        bool genlock_locked() override;
+
+        void configure_keyer() override;
+        void disable_keyer() override;
+
+        void enable_loopback() override;
+        void disable_loopback() override;
+
+    private:
+        std::shared_ptr<Deltacast::Wrapper::Board> _board;
+        std::shared_ptr<BoardGenlock> _genlock;
+        unsigned int _rx_stream_id;
+        unsigned int _tx_stream_id;
+        const char* _log_prefix;
+    };
+}
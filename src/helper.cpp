@@ -15,7 +15,6 @@
 
 #include "helper.hpp"
 
-#include <thread>
 #include <utility>
 #include <optional>
 #include <VideoMasterCppApi/to_string.hpp>
@@ -129,6 +128,19 @@ namespace Application::Helper
         }
     }
 
+    VHD_GENLOCKSOURCE rx_to_genlock_source(unsigned int rx_index)
+    {
+        switch (rx_index)
+        {
+        case 0: return VHD_GENLOCK_RX0;
+        case 1: return VHD_GENLOCK_RX1;
+        case 2: return VHD_GENLOCK_RX2;
+        case 3: return VHD_GENLOCK_RX3;
+        default:
+            throw std::invalid_argument("Invalid RX index");
+        }
+    }
+
     VHD_KEYERINPUT tx_to_keyer_input(unsigned int tx_index)
     {
         switch (tx_index)
@@ -188,22 +200,6 @@ namespace Application::Helper
         }
     }
 
-    bool wait_for_input(BoardComponents::RxConnector& rx_connector, const std::atomic_bool& stop_is_requested)
-    {
-        while (!stop_is_requested && !rx_connector.signal_present())
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        return rx_connector.signal_present();
-    }
-
-    bool wait_for_genlock(Deltacast::Wrapper::BoardComponents::SdiComponents::Genlock& genlock, const std::atomic_bool& stop_is_requested)
-    {
-        while (!stop_is_requested && !genlock.locked())
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        return genlock.locked();
-    }
-
     TechStream open_stream(Board& board, VHD_STREAMTYPE stream_type)
     {
         auto channel_type = stream_type_to_channel_type(board, stream_type);
@@ -257,6 +253,18 @@ namespace Application::Helper
         }, stream);
     }
 
+    bool same_genlock_reference(const SignalInformation& signal_information, const SignalInformation& other)
+    {
+        const auto* sdi_signal_information = std::get_if<SdiSignalInformation>(&signal_information);
+        const auto* other_sdi_signal_information = std::get_if<SdiSignalInformation>(&other);
+        if (!sdi_signal_information || !other_sdi_signal_information)
+            return signal_information == other;
+
+        // The genlock only depends on the frame rate and scanning of the standard, not on the interface carrying it
+        return sdi_signal_information->video_standard == other_sdi_signal_information->video_standard
+                && sdi_signal_information->clock_divisor == other_sdi_signal_information->clock_divisor;
+    }
+
     void print_information(const SignalInformation& signal_information, const std::string& prefix /*= ""*/)
     {
         std::visit(overloaded{
@@ -305,4 +313,52 @@ namespace Application::Helper
             }
         }, signal_information);
     }
+
+    namespace
+    {
+        // Packings the application can carry, the conversions between them are looked up from the pixel formats
+        const std::pair<VHD_BUFFERPACKING, Processing::PixelFormat> buffer_packings[] = {
+            { VHD_BUFPACK_VIDEO_RGB_24, Processing::PixelFormat::rgb_24 },
+            { VHD_BUFPACK_VIDEO_RGBA_32, Processing::PixelFormat::rgba_32 },
+            { VHD_BUFPACK_VIDEO_YUV422_8, Processing::PixelFormat::yuv_422_8 },
+            { VHD_BUFPACK_VIDEO_YUV422_10, Processing::PixelFormat::yuv_422_10 },
+            { VHD_BUFPACK_VIDEO_RGB_32, Processing::PixelFormat::rgb_30 },
+        };
+    }
+
+    Processing::PixelFormat to_pixel_format(VHD_BUFFERPACKING buffer_packing)
+    {
+        for (const auto& [packing, pixel_format] : buffer_packings)
+            if (packing == buffer_packing)
+                return pixel_format;
+        return Processing::PixelFormat::unknown;
+    }
+
+    std::optional<VHD_BUFFERPACKING> to_buffer_packing(Processing::PixelFormat pixel_format)
+    {
+        for (const auto& [packing, format] : buffer_packings)
+            if (format == pixel_format)
+                return packing;
+        return std::nullopt;
+    }
+
+    Processing::FieldOrder get_field_order(const SignalInformation& signal_information)
+    {
+        const auto video_characteristics = get_video_characteristics(signal_information);
+        if (!video_characteristics.interlaced)
+            return Processing::FieldOrder::progressive;
+
+        // The 525-line standards carry their bottom field first, the 625-line and HD ones their top field
+        return (video_characteristics.height >= 480 && video_characteristics.height <= 487) ? Processing::FieldOrder::bottom_field_first
+                                                                                            : Processing::FieldOrder::top_field_first;
+    }
+
+    Processing::FrameDescriptor get_frame_descriptor(const SignalInformation& signal_information, VHD_BUFFERPACKING buffer_packing)
+    {
+        const auto video_characteristics = get_video_characteristics(signal_information);
+        const auto pixel_format = to_pixel_format(buffer_packing);
+
+        return { video_characteristics.width, video_characteristics.height, Processing::line_stride(pixel_format, video_characteristics.width)
+                , pixel_format, get_field_order(signal_information) };
+    }
 }
\ No newline at end of file
@@ -13,8 +13,10 @@
  * limitations under the License.
  */
 
+#pragma once
+
 #include <iostream>
-#include <atomic>
+#include <optional>
 #include <variant>
 
 #include <VideoMasterCppApi/helper/video.hpp>
@@ -22,6 +24,8 @@
 #include <VideoMasterCppApi/stream/sdi/sdi_stream.hpp>
 #include <VideoMasterCppApi/stream/dv/dv_stream.hpp>
 
+#include "processing.hpp"
+
 std::ostream& operator<<(std::ostream& os, Deltacast::Wrapper::Board& board);
 
 namespace Application::Helper
@@ -33,12 +37,10 @@ namespace Application::Helper
     VHD_STREAMTYPE tx_index_to_streamtype(unsigned int tx_index);
     
     VHD_KEYERINPUT rx_to_keyer_input(unsigned int rx_index);
+    VHD_GENLOCKSOURCE rx_to_genlock_source(unsigned int rx_index);
     VHD_KEYERINPUT tx_to_keyer_input(unsigned int tx_index);
     VHD_KEYEROUTPUT rx_to_keyer_output(unsigned int rx_index);
 
-    bool wait_for_input(Deltacast::Wrapper::BoardComponents::RxConnector& rx_connector, const std::atomic_bool& stop_is_requested);
-    bool wait_for_genlock(Deltacast::Wrapper::BoardComponents::SdiComponents::Genlock& genlock, const std::atomic_bool& stop_is_requested);
-
     using TechStream = std::variant<Deltacast::Wrapper::SdiStream, Deltacast::Wrapper::DvStream>;
     TechStream open_stream(Deltacast::Wrapper::Board& board, VHD_STREAMTYPE stream_type);
     Deltacast::Wrapper::Stream& to_base_stream(TechStream& stream);
@@ -81,8 +83,14 @@ namespace Application::Helper
     using SignalInformation = std::variant<SdiSignalInformation, DvSignalInformation>;
 
     void configure_stream(TechStream& stream, const SignalInformation& signal_information);
+    // Whether the genlock configured for one signal also locks onto the other one
+    bool same_genlock_reference(const SignalInformation& signal_information, const SignalInformation& other);
     void print_information(const SignalInformation& signal_information, const std::string& prefix = "");
     SignalInformation detect_information(TechStream& stream);
 
     Deltacast::Wrapper::Helper::VideoCharacteristics get_video_characteristics(const SignalInformation& signal_information);
+    Processing::PixelFormat to_pixel_format(VHD_BUFFERPACKING buffer_packing);
+    std::optional<VHD_BUFFERPACKING> to_buffer_packing(Processing::PixelFormat pixel_format);
+    Processing::FieldOrder get_field_order(const SignalInformation& signal_information);
+    Processing::FrameDescriptor get_frame_descriptor(const SignalInformation& signal_information, VHD_BUFFERPACKING buffer_packing);
 }
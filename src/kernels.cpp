@@ -0,0 +1,250 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define KERNELS_TARGET(instruction_sets)
+#else
+#define KERNELS_TARGET(instruction_sets) __attribute__((target(instruction_sets)))
+#endif
+
+namespace Application::Kernels
+{
+    namespace
+    {
+        void rgb_24_to_rgba_32_scalar(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            for (uint32_t i = 0; i < number_of_pixels; ++i)
+            {
+                destination[i * 4 + 0] = source[i * 3 + 0];
+                destination[i * 4 + 1] = source[i * 3 + 1];
+                destination[i * 4 + 2] = source[i * 3 + 2];
+                destination[i * 4 + 3] = 0xFF;
+            }
+        }
+
+        void downscale_rgb_24_scalar(const uint8_t* top_line, const uint8_t* bottom_line, uint8_t* destination, uint32_t destination_width)
+        {
+            for (uint32_t i = 0; i < destination_width * 3; ++i)
+            {
+                const uint32_t source = (i / 3) * 6 + (i % 3);
+                destination[i] = static_cast<uint8_t>((top_line[source] + top_line[source + 3] + bottom_line[source] + bottom_line[source + 3] + 2) >> 2);
+            }
+        }
+
+    #ifdef KERNELS_X86
+        KERNELS_TARGET("ssse3")
+        void rgb_24_to_rgba_32_ssse3(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+            uint32_t i = 0;
+            for (; i + 16 <= number_of_pixels; i += 16)
+            {
+                const __m128i* input = reinterpret_cast<const __m128i*>(source + i * 3);
+                __m128i* output = reinterpret_cast<__m128i*>(destination + i * 4);
+
+                const __m128i a = _mm_loadu_si128(input + 0);
+                const __m128i b = _mm_loadu_si128(input + 1);
+                const __m128i c = _mm_loadu_si128(input + 2);
+
+                _mm_storeu_si128(output + 0, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+                _mm_storeu_si128(output + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), alpha));
+                _mm_storeu_si128(output + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), alpha));
+                _mm_storeu_si128(output + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), alpha));
+            }
+
+            rgb_24_to_rgba_32_scalar(source + i * 3, destination + i * 4, number_of_pixels - i);
+        }
+
+        // Rounded average of the four bytes of each lane, summed in 16-bit lanes so that it is rounded once like the scalar kernel
+        KERNELS_TARGET("ssse3")
+        inline __m128i average_4_epu8(__m128i a, __m128i b, __m128i c, __m128i d)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi16(2);
+            const __m128i low = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero))
+                                            , _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+            const __m128i high = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero))
+                                             , _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+            return _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(low, rounding), 2), _mm_srli_epi16(_mm_add_epi16(high, rounding), 2));
+        }
+
+        KERNELS_TARGET("ssse3")
+        void downscale_rgb_24_ssse3(const uint8_t* top_line, const uint8_t* bottom_line, uint8_t* destination, uint32_t destination_width)
+        {
+            // Once each byte is averaged with the same component of the next pixel, the even pixels of the 16 input ones hold the 8 output ones
+            const __m128i first_from_0 = _mm_setr_epi8(0, 1, 2, 6, 7, 8, 12, 13, 14, -1, -1, -1, -1, -1, -1, -1);
+            const __m128i first_from_1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 3, 4, 8, 9, 10, 14);
+            const __m128i second_from_1 = _mm_setr_epi8(15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m128i second_from_2 = _mm_setr_epi8(-1, 0, 4, 5, 6, 10, 11, 12, -1, -1, -1, -1, -1, -1, -1, -1);
+
+            uint32_t i = 0;
+            for (; i + 8 <= destination_width; i += 8)
+            {
+                const __m128i* top = reinterpret_cast<const __m128i*>(top_line + i * 6);
+                const __m128i* bottom = reinterpret_cast<const __m128i*>(bottom_line + i * 6);
+
+                const __m128i top_a = _mm_loadu_si128(top + 0), top_b = _mm_loadu_si128(top + 1), top_c = _mm_loadu_si128(top + 2);
+                const __m128i bottom_a = _mm_loadu_si128(bottom + 0), bottom_b = _mm_loadu_si128(bottom + 1), bottom_c = _mm_loadu_si128(bottom + 2);
+
+                const __m128i horizontal_a = average_4_epu8(top_a, _mm_alignr_epi8(top_b, top_a, 3), bottom_a, _mm_alignr_epi8(bottom_b, bottom_a, 3));
+                const __m128i horizontal_b = average_4_epu8(top_b, _mm_alignr_epi8(top_c, top_b, 3), bottom_b, _mm_alignr_epi8(bottom_c, bottom_b, 3));
+                const __m128i horizontal_c = average_4_epu8(top_c, _mm_srli_si128(top_c, 3), bottom_c, _mm_srli_si128(bottom_c, 3));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 3)
+                               , _mm_or_si128(_mm_shuffle_epi8(horizontal_a, first_from_0), _mm_shuffle_epi8(horizontal_b, first_from_1)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i * 3 + 16)
+                               , _mm_or_si128(_mm_shuffle_epi8(horizontal_b, second_from_1), _mm_shuffle_epi8(horizontal_c, second_from_2)));
+            }
+
+            downscale_rgb_24_scalar(top_line + i * 6, bottom_line + i * 6, destination + i * 3, destination_width - i);
+        }
+
+        KERNELS_TARGET("avx2")
+        void rgb_24_to_rgba_32_avx2(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            const __m256i permutation = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+            const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+                                                   , 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+            // Each 32 bytes load only consumes 24 bytes, stop early enough not to read past the source
+            uint32_t i = 0;
+            for (; i + 11 <= number_of_pixels; i += 8)
+            {
+                __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 3));
+                pixels = _mm256_permutevar8x32_epi32(pixels, permutation);
+                pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 4), pixels);
+            }
+
+            rgb_24_to_rgba_32_scalar(source + i * 3, destination + i * 4, number_of_pixels - i);
+        }
+
+        KERNELS_TARGET("avx512f,avx512bw")
+        void rgb_24_to_rgba_32_avx512(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels)
+        {
+            // The zero-masking forms over all lanes avoid the undefined passthrough vectors of the unmasked intrinsics, which GCC reports as uninitialized
+            const __mmask16 all_lanes = 0xFFFF;
+            const __m512i permutation = _mm512_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0, 6, 7, 8, 0, 9, 10, 11, 0);
+            const __m512i shuffle = _mm512_maskz_broadcast_i32x4(all_lanes, _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+            const __m512i alpha = _mm512_set1_epi32(static_cast<int>(0xFF000000));
+            const __mmask64 load_mask = 0x0000FFFFFFFFFFFFull;
+
+            uint32_t i = 0;
+            for (; i + 16 <= number_of_pixels; i += 16)
+            {
+                __m512i pixels = _mm512_maskz_loadu_epi8(load_mask, source + i * 3);
+                pixels = _mm512_maskz_permutexvar_epi32(all_lanes, permutation, pixels);
+                pixels = _mm512_or_si512(_mm512_shuffle_epi8(pixels, shuffle), alpha);
+                _mm512_storeu_si512(destination + i * 4, pixels);
+            }
+
+            rgb_24_to_rgba_32_scalar(source + i * 3, destination + i * 4, number_of_pixels - i);
+        }
+    #endif
+    }
+
+    InstructionSet detect_instruction_set()
+    {
+    #if defined(KERNELS_X86) && defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int highest_leaf = info[0];
+
+        __cpuid(info, 1);
+        const bool ssse3 = (info[2] & (1 << 9)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+
+        bool avx2 = false, avx512 = false;
+        if (highest_leaf >= 7 && osxsave)
+        {
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            avx2 = ((xcr0 & 0x06) == 0x06) && (info[1] & (1 << 5)) != 0;
+            avx512 = ((xcr0 & 0xE6) == 0xE6) && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+        }
+
+        if (avx512)
+            return InstructionSet::avx512;
+        if (avx2)
+            return InstructionSet::avx2;
+        if (ssse3)
+            return InstructionSet::ssse3;
+    #elif defined(KERNELS_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return InstructionSet::avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return InstructionSet::avx2;
+        if (__builtin_cpu_supports("ssse3"))
+            return InstructionSet::ssse3;
+    #endif
+        return InstructionSet::scalar;
+    }
+
+    const char* to_string(InstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+        case InstructionSet::ssse3: return "SSSE3";
+        case InstructionSet::avx2: return "AVX2";
+        case InstructionSet::avx512: return "AVX-512";
+        case InstructionSet::scalar:
+        default: return "scalar";
+        }
+    }
+
+    Rgb24ToRgba32 select_rgb_24_to_rgba_32(InstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+    #ifdef KERNELS_X86
+        case InstructionSet::avx512: return rgb_24_to_rgba_32_avx512;
+        case InstructionSet::avx2: return rgb_24_to_rgba_32_avx2;
+        case InstructionSet::ssse3: return rgb_24_to_rgba_32_ssse3;
+    #endif
+        default: return rgb_24_to_rgba_32_scalar;
+        }
+    }
+
+    DownscaleRgb24 select_downscale_rgb_24(InstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+    #ifdef KERNELS_X86
+        // The wider instruction sets would not help this memory-bound kernel, whose shuffles stay within 128-bit lanes
+        case InstructionSet::avx512:
+        case InstructionSet::avx2:
+        case InstructionSet::ssse3: return downscale_rgb_24_ssse3;
+    #endif
+        default: return downscale_rgb_24_scalar;
+        }
+    }
+
+    const Rgb24ToRgba32 rgb_24_to_rgba_32 = select_rgb_24_to_rgba_32(detect_instruction_set());
+    const DownscaleRgb24 downscale_rgb_24 = select_downscale_rgb_24(detect_instruction_set());
+}
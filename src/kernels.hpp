@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Application::Kernels
+{
+    enum class InstructionSet
+    {
+        scalar,
+        ssse3,
+        avx2,
+        avx512,
+    };
+
+    InstructionSet detect_instruction_set();
+    const char* to_string(InstructionSet instruction_set);
+
+    // Expands RGB 8b pixels to RGBA 8b pixels with an opaque alpha channel
+    using Rgb24ToRgba32 = void (*)(const uint8_t* source, uint8_t* destination, uint32_t number_of_pixels);
+
+    Rgb24ToRgba32 select_rgb_24_to_rgba_32(InstructionSet instruction_set);
+
+    // Averages each 2x2 block of RGB 8b pixels of two consecutive lines into one pixel
+    using DownscaleRgb24 = void (*)(const uint8_t* top_line, const uint8_t* bottom_line, uint8_t* destination, uint32_t destination_width);
+
+    DownscaleRgb24 select_downscale_rgb_24(InstructionSet instruction_set);
+
+    // Implementations selected once at startup for the best instruction set supported by the CPU
+    extern const Rgb24ToRgba32 rgb_24_to_rgba_32;
+    extern const DownscaleRgb24 downscale_rgb_24;
+}
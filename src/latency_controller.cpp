@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "latency_controller.hpp"
+
+#include <algorithm>
+
+namespace Application::Control
+{
+    void LatencyController::configure(unsigned int target_filling, std::chrono::nanoseconds frame_period)
+    {
+        _target_filling = target_filling;
+        _frame_period = frame_period;
+        _processing_times.clear();
+        _predicted_processing_time = 0;
+        _previous_frame_skipped = false;
+        _processed = 0;
+        _skipped_for_queue_depth = 0;
+        _skipped_for_deadline = 0;
+        _stale = 0;
+    }
+
+    LatencyController::Decision LatencyController::decide(unsigned int queue_filling, Statistics::Clock::duration frame_age)
+    {
+        // Frames whose processing ends after their deadline reach the queue one frame period later for each period of delay
+        unsigned int late_periods = 0;
+        if (_frame_period.count() > 0)
+            late_periods = static_cast<unsigned int>((std::max(frame_age, Statistics::Clock::duration::zero()) + predicted_processing_time()) / _frame_period);
+
+        Decision decision = Decision::process;
+        // A single skip lowers the filling by one frame, skipping again before the queue could drain would only drop frames in bursts
+        if (!_previous_frame_skipped)
+        {
+            if (queue_filling > _target_filling)
+                decision = Decision::skip_for_queue_depth;
+            else if (queue_filling + late_periods > _target_filling)
+                decision = Decision::skip_for_deadline;
+        }
+
+        _previous_frame_skipped = (decision != Decision::process);
+        switch (decision)
+        {
+        case Decision::process: ++_processed; break;
+        case Decision::skip_for_queue_depth: ++_skipped_for_queue_depth; break;
+        case Decision::skip_for_deadline: ++_skipped_for_deadline; break;
+        }
+        return decision;
+    }
+
+    void LatencyController::record_processing(Statistics::Clock::duration processing_time)
+    {
+        _processing_times.record(processing_time);
+        _predicted_processing_time = std::chrono::duration_cast<std::chrono::nanoseconds>(_processing_times.percentile(prediction_percentile)).count();
+    }
+
+    void LatencyController::record_stale(unsigned int number_of_frames)
+    {
+        _stale += number_of_frames;
+    }
+
+    std::chrono::nanoseconds LatencyController::predicted_processing_time() const
+    {
+        return std::chrono::nanoseconds(_predicted_processing_time.load());
+    }
+
+    LatencyController::Counters LatencyController::counters() const
+    {
+        return { _processed, _skipped_for_queue_depth, _skipped_for_deadline, _stale };
+    }
+}
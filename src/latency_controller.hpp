@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "statistics.hpp"
+
+namespace Application::Control
+{
+    // Decides, before a frame is processed, whether it should be skipped so that the TX buffer queue stays at its target filling.
+    // The filling the frame would find once processed is predicted from the current filling, the age of the frame and a high
+    // percentile of the processing times of the last frames, so that skips happen ahead of a deadline miss and never twice in a row.
+    // Decisions are taken by the TX thread only, their counters can be read from any thread.
+    class LatencyController
+    {
+    public:
+        static constexpr unsigned int prediction_percentile = 90;
+
+        enum class Decision
+        {
+            process,
+            skip_for_queue_depth,
+            skip_for_deadline,
+        };
+
+        struct Counters
+        {
+            uint64_t processed = 0;
+            uint64_t skipped_for_queue_depth = 0;
+            uint64_t skipped_for_deadline = 0;
+            uint64_t stale = 0;
+        };
+
+        void configure(unsigned int target_filling, std::chrono::nanoseconds frame_period);
+
+        Decision decide(unsigned int queue_filling, Statistics::Clock::duration frame_age);
+        void record_processing(Statistics::Clock::duration processing_time);
+        // Frames replaced by a newer one before being considered
+        void record_stale(unsigned int number_of_frames);
+
+        unsigned int target_filling() const { return _target_filling; }
+        std::chrono::nanoseconds predicted_processing_time() const;
+        Counters counters() const;
+
+    private:
+        unsigned int _target_filling = 0;
+        std::chrono::nanoseconds _frame_period = std::chrono::nanoseconds(0);
+
+        Statistics::TimingWindow _processing_times;
+        std::atomic<int64_t> _predicted_processing_time = 0;
+        bool _previous_frame_skipped = false;
+
+        std::atomic<uint64_t> _processed = 0;
+        std::atomic<uint64_t> _skipped_for_queue_depth = 0;
+        std::atomic<uint64_t> _skipped_for_deadline = 0;
+        std::atomic<uint64_t> _stale = 0;
+    };
+}
@@ -0,0 +1,199 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logger.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Application::Logging
+{
+    bool RecordRing::push(const Record& record)
+    {
+        const uint64_t pushed = _pushed.load(std::memory_order_relaxed);
+        if (pushed - _popped.load(std::memory_order_acquire) >= capacity)
+        {
+            _lost.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _records[pushed % capacity] = record;
+        _pushed.store(pushed + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool RecordRing::pop(Record& record)
+    {
+        const uint64_t popped = _popped.load(std::memory_order_relaxed);
+        if (popped == _pushed.load(std::memory_order_acquire))
+            return false;
+
+        record = _records[popped % capacity];
+        _popped.store(popped + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t RecordRing::take_lost()
+    {
+        return _lost.exchange(0, std::memory_order_relaxed);
+    }
+
+    namespace
+    {
+        void format(std::ostream& os, const Record& record)
+        {
+            switch (record.event)
+            {
+                case Event::timeout:
+                    os << record.prefix << record.name << ": Timeout" << std::endl;
+                    break;
+                case Event::slots_dropped:
+                    os << "INFO for " << record.prefix << record.name << ": Dropped occurred: slots count=" << record.values[0] << ", slots dropped=" << record.values[1] << std::endl;
+                    break;
+                case Event::buffers_too_small:
+                    os << record.prefix << record.name << ": Buffers smaller than the configured frame layouts, frame not processed" << std::endl;
+                    break;
+                case Event::unknown_buffer:
+                    os << record.prefix << record.name << ": Captured frame outside of the application buffers, frame not sent" << std::endl;
+                    break;
+                case Event::api_error:
+                    os << record.prefix << "ERROR: " << record.name << " failed (error = " << record.values[0] << ")" << std::endl;
+                    break;
+            }
+        }
+
+        class Logger
+        {
+        public:
+            ~Logger() { stop(); }
+
+            void add(std::shared_ptr<RecordRing> ring)
+            {
+                std::lock_guard lock(_mutex);
+                _rings.push_back(std::move(ring));
+            }
+
+            void start(std::chrono::milliseconds flush_period)
+            {
+                std::lock_guard lock(_thread_mutex);
+                if (_thread.joinable())
+                    return;
+
+                _stop = false;
+                _thread = std::thread([this, flush_period]
+                {
+                    while (!_stop)
+                    {
+                        std::this_thread::sleep_for(flush_period);
+                        flush();
+                    }
+                });
+            }
+
+            void stop()
+            {
+                std::lock_guard lock(_thread_mutex);
+                _stop = true;
+                if (_thread.joinable())
+                    _thread.join();
+                flush();
+            }
+
+        private:
+            std::mutex _mutex;
+            std::vector<std::shared_ptr<RecordRing>> _rings;
+
+            std::mutex _thread_mutex;
+            std::thread _thread;
+            std::atomic_bool _stop = false;
+
+            // Only called by the logging thread, or once it has stopped
+            void flush()
+            {
+                std::vector<Record> records;
+                uint64_t lost = 0;
+                {
+                    std::lock_guard lock(_mutex);
+                    for (auto it = _rings.begin(); it != _rings.end();)
+                    {
+                        // Retired rings are no longer pushed to and are dropped once drained
+                        const bool retired = (*it)->retired;
+                        Record record;
+                        while ((*it)->pop(record))
+                            records.push_back(record);
+                        lost += (*it)->take_lost();
+                        it = retired ? _rings.erase(it) : it + 1;
+                    }
+                }
+                if (records.empty() && lost == 0)
+                    return;
+
+                // Records of concurrent threads are printed in the order they were pushed, without holding the threads registering their ring
+                std::stable_sort(records.begin(), records.end(), [](const Record& record, const Record& other) { return record.timestamp < other.timestamp; });
+                std::ostringstream output;
+                for (const auto& record : records)
+                    format(output, record);
+                if (lost > 0)
+                    output << "WARNING: " << lost << " log records lost" << std::endl;
+                std::cout << output.str() << std::flush;
+            }
+        };
+
+        Logger& logger()
+        {
+            static Logger instance;
+            return instance;
+        }
+
+        struct ThreadRing
+        {
+            std::shared_ptr<RecordRing> ring = std::make_shared<RecordRing>();
+
+            ThreadRing() { logger().add(ring); }
+            ~ThreadRing() { ring->retired = true; }
+        };
+
+        RecordRing& thread_ring()
+        {
+            thread_local ThreadRing thread_ring;
+            return *thread_ring.ring;
+        }
+    }
+
+    void register_thread()
+    {
+        thread_ring();
+    }
+
+    void log(Event event, const char* prefix, const char* name, uint64_t first_value /*= 0*/, uint64_t second_value /*= 0*/)
+    {
+        thread_ring().push({ Clock::now(), event, prefix, name, { first_value, second_value } });
+    }
+
+    void start(std::chrono::milliseconds flush_period /*= std::chrono::milliseconds(10)*/)
+    {
+        logger().start(flush_period);
+    }
+
+    void stop()
+    {
+        logger().stop();
+    }
+}
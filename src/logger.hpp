@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Application::Logging
+{
+    using Clock = std::chrono::steady_clock;
+
+    enum class Event
+    {
+        timeout,
+        slots_dropped,
+        buffers_too_small,
+        unknown_buffer,
+        api_error,
+    };
+
+    // Fixed-size record formatted by the logging thread. Strings must outlive the logging thread, such as literals or channel prefixes.
+    struct Record
+    {
+        Clock::time_point timestamp;
+        Event event;
+        const char* prefix;
+        const char* name;
+        uint64_t values[2];
+    };
+
+    // Single-producer single-consumer ring of the records of one thread, which never blocks its producer
+    class RecordRing
+    {
+    public:
+        static constexpr unsigned int capacity = 1024;
+
+        // Returns false and counts the record as lost when the ring is full
+        bool push(const Record& record);
+        bool pop(Record& record);
+        uint64_t take_lost();
+
+        std::atomic_bool retired = false;
+
+    private:
+        std::array<Record, capacity> _records;
+        std::atomic<uint64_t> _pushed = 0;
+        std::atomic<uint64_t> _popped = 0;
+        std::atomic<uint64_t> _lost = 0;
+    };
+
+    // Allocates the ring of the calling thread and registers it with the logging thread up front, so that its first record does not allocate or wait
+    void register_thread();
+
+    // Pushes a record into the ring of the calling thread, registered with the logging thread on its first record if register_thread() was not called.
+    // Meant for the real-time threads, which must not wait on the terminal or the journal.
+    void log(Event event, const char* prefix, const char* name, uint64_t first_value = 0, uint64_t second_value = 0);
+
+    // Starts the thread formatting and printing the records of all threads every flush period,
+    // stop() prints the pending records and the number of records lost to full rings
+    void start(std::chrono::milliseconds flush_period = std::chrono::milliseconds(10));
+    void stop();
+}
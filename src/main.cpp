@@ -13,10 +13,19 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <csignal>
+#include <cstring>
 #include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include <CLI/CLI.hpp>
 
@@ -31,24 +40,62 @@
 #include "windowed_renderer.hpp"
 #include "allocation.hpp"
 #include "processing.hpp"
+#include "kernels.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "tracing.hpp"
+#include "thread_policy.hpp"
+#include "hardware_backend.hpp"
+#include "signal_monitor.hpp"
+#include "simulated_backend.hpp"
 
 using namespace std::chrono_literals;
 using namespace Deltacast::Wrapper;
 
-Deltacast::SharedResources shared_resources;
+// Connector pair of a device whose input is keyed back onto its output
+struct Channel
+{
+    unsigned int device_id;
+    unsigned int rx_stream_id;
+    unsigned int tx_stream_id;
+};
+
+// Settings shared by the pipelines of every channel
+struct PipelineSettings
+{
+    bool overlay_enabled;
+    bool renderer_enabled;
+    Application::Processing::PixelFormat capture_pixel_format;
+    bool zero_copy;
+    bool quality_degradation;
+    bool async_overlay;
+    Application::Threading::ThreadPolicy rx_thread_policy;
+    Application::Threading::ThreadPolicy tx_thread_policy;
+    Application::Threading::ThreadPolicy renderer_thread_policy;
+};
+
+// One set of shared resources per channel, created before SIGINT is handled
+std::vector<std::unique_ptr<Deltacast::SharedResources>> channels_shared_resources;
 
 void on_close(int /*signal*/)
 {
-    shared_resources.synchronization.stop_is_requested = true;
+    for (auto& shared_resources : channels_shared_resources)
+        shared_resources->synchronization.stop_is_requested = true;
 }
 
-bool rx_loop(Application::Helper::TechStream& rx_tech_stream, Deltacast::SharedResources& shared_resources);
-bool tx_loop(Deltacast::Wrapper::Board& board, Application::Helper::TechStream& tx_tech_stream, Application::Processing::Processor processor, Deltacast::SharedResources& shared_resources);
+void on_dump_trace(int /*signal*/)
+{
+    Application::Tracing::request_dump();
+}
 
-void configure_genlock(Deltacast::Wrapper::BoardComponents::SdiComponents::Genlock& genlock, const Application::Helper::SdiSignalInformation& sdi_signal_info);
-void configure_keyer(Deltacast::Wrapper::BoardComponents::Keyer& keyer, unsigned int rx_stream_id, unsigned int tx_stream_id);
-void configure_rx_stream(Application::Helper::TechStream& rx_tech_stream, const Application::Helper::SignalInformation& signal_information, unsigned int number_of_slots);
-void configure_tx_stream(Application::Helper::TechStream& tx_tech_stream, const Application::Helper::SignalInformation& signal_information, bool overlay_enabled, unsigned int number_of_slots);
+std::optional<Channel> parse_channel(const std::string& mapping);
+int run_channel(const Channel& channel, Application::Backend::Device& device, const PipelineSettings& settings, Application::Threading::WorkerPool& worker_pool
+              , Application::Allocation::BufferPool& buffer_pool, Deltacast::SharedResources& shared_resources);
+bool rx_loop(Application::Backend::Stream& rx_stream, const Application::Processing::FrameDescriptor& frame_descriptor, Deltacast::SharedResources& shared_resources);
+bool tx_loop(Application::Backend::Device& device, Application::Backend::Stream& tx_stream, Application::Processing::Processor& processor, Deltacast::SharedResources& shared_resources);
+bool tx_loop_zero_copy(Application::Backend::Device& device, Application::Backend::Stream& tx_stream, Application::Backend::ApplicationBuffers& application_buffers, Deltacast::SharedResources& shared_resources);
+bool overlay_loop(Application::Processing::Processor& processor, Deltacast::SharedResources& shared_resources);
+bool tx_loop_async_overlay(Application::Backend::Device& device, Application::Backend::Stream& tx_stream, const Application::Processing::FrameDescriptor& frame_descriptor, Deltacast::SharedResources& shared_resources);
 
 int main(int argc, char** argv)
 {
@@ -59,210 +106,623 @@ int main(int argc, char** argv)
     app.add_option("-i,--input", rx_stream_id, "ID of the input connector to use");
     unsigned int tx_stream_id = 0;
     app.add_option("-o,--output", tx_stream_id, "ID of the output connector to use");
+    std::vector<std::string> channel_mappings;
+    app.add_option("-c,--channels", channel_mappings, "Comma-separated list of device:input:output mappings processed by as many pipelines (replaces -d, -i and -o)")->delimiter(',');
     bool overlay_enabled = false;
     app.add_flag("--overlay,!--no-overlay", overlay_enabled, "Activates overlay on the output stream");
     bool renderer_enabled = false;
     app.add_flag("--renderer,!--no-renderer", renderer_enabled, "Activates rendering of the live input stream");
-    shared_resources.maximum_latency = 2;
-    app.add_option("-l,--maximum-latency", shared_resources.maximum_latency, "Maximum desired latency in frames between input and output");
+    unsigned int preview_scale = 2;
+    app.add_option("--preview-scale", preview_scale, "Factor by which the live input stream is downscaled for rendering")->check(CLI::IsMember(std::vector<unsigned int>{ 1, 2, 4 }));
+    const std::map<std::string, Application::Processing::PixelFormat> capture_formats = {
+        { "rgb-8", Application::Processing::PixelFormat::rgb_24 },
+        { "rgb-10", Application::Processing::PixelFormat::rgb_30 },
+        { "yuv422-8", Application::Processing::PixelFormat::yuv_422_8 },
+        { "yuv422-10", Application::Processing::PixelFormat::yuv_422_10 },
+    };
+    std::string capture_format = "rgb-8";
+    std::vector<std::string> capture_format_names;
+    for (const auto& [ name, pixel_format ] : capture_formats)
+        capture_format_names.push_back(name);
+    app.add_option("--capture-format", capture_format, "Pixel format in which the input stream is captured, and passed through in non-overlay mode")->check(CLI::IsMember(capture_format_names));
+    unsigned int processing_threads = 0;
+    app.add_option("--processing-threads", processing_threads, "Number of processing worker threads (0 sizes the pool to the machine)");
+    Application::Threading::ThreadPolicy rx_thread_policy, tx_thread_policy, renderer_thread_policy, processing_thread_policy;
+    app.add_option("--processing-cores", processing_thread_policy.cores, "Comma-separated list of cores the processing workers are pinned to")->delimiter(',');
+    app.add_option("--rx-cores", rx_thread_policy.cores, "Comma-separated list of cores the RX threads run on")->delimiter(',');
+    app.add_option("--tx-cores", tx_thread_policy.cores, "Comma-separated list of cores the TX threads run on")->delimiter(',');
+    app.add_option("--renderer-cores", renderer_thread_policy.cores, "Comma-separated list of cores the rendering threads run on")->delimiter(',');
+    app.add_option("--rx-priority", rx_thread_policy.priority, "Real-time priority of the RX threads, from 1 to 99 (0 keeps the default scheduling)")->check(CLI::Range(0, 99));
+    app.add_option("--tx-priority", tx_thread_policy.priority, "Real-time priority of the TX threads, from 1 to 99 (0 keeps the default scheduling)")->check(CLI::Range(0, 99));
+    app.add_option("--renderer-priority", renderer_thread_policy.priority, "Real-time priority of the rendering threads, from 1 to 99 (0 keeps the default scheduling)")->check(CLI::Range(0, 99));
+    app.add_option("--processing-priority", processing_thread_policy.priority, "Real-time priority of the processing workers, from 1 to 99 (0 keeps the default scheduling)")->check(CLI::Range(0, 99));
+    std::string scheduling_policy = "fifo";
+    app.add_option("--scheduling-policy", scheduling_policy, "Real-time scheduling policy of the threads given a priority")->check(CLI::IsMember(std::vector<std::string>{ "fifo", "rr" }));
+    bool memory_locking = false;
+    app.add_flag("--lock-memory", memory_locking, "Locks the process memory so that it is never paged out");
+    unsigned int maximum_latency = 2;
+    app.add_option("-l,--maximum-latency", maximum_latency, "Maximum desired latency in frames between input and output");
+    unsigned int frame_ring_depth = 2;
+    app.add_option("--frame-ring-depth", frame_ring_depth, "Number of captured frames that can be in flight between input and output at once");
+    bool low_latency_wakeup = false;
+    app.add_flag("--low-latency-wakeup,!--no-low-latency-wakeup", low_latency_wakeup, "Spins before blocking when waiting for the RX/TX handoff");
+    unsigned int wakeup_spin_budget_us = 50;
+    app.add_option("--wakeup-spin-budget", wakeup_spin_budget_us, "Time in microseconds spent spinning before blocking in low latency wakeup mode");
+    bool huge_pages_enabled = true;
+    app.add_flag("--huge-pages,!--no-huge-pages", huge_pages_enabled, "Backs the application frame buffers with huge pages when available");
+    bool zero_copy = false;
+    app.add_flag("--zero-copy", zero_copy, "Shares application buffers between input and output so that frames are passed through without copy (non-overlay mode only)");
+    bool async_overlay = false;
+    app.add_flag("--async-overlay", async_overlay, "Generates the overlay on its own thread at the rate it can sustain, the output keying the latest completed overlay at every frame (overlay mode only)");
+    bool quality_degradation = true;
+    app.add_flag("--quality-degradation,!--no-quality-degradation", quality_degradation, "Lowers the processing quality when it no longer fits the latency budget instead of dropping output frames");
+    std::string metrics_file;
+    app.add_option("--metrics-file", metrics_file, "File the metrics are written to every second in the Prometheus text format");
+    unsigned int metrics_port = 0;
+    app.add_option("--metrics-port", metrics_port, "Port of the HTTP endpoint serving the metrics in the Prometheus text format on the loopback interface")->check(CLI::Range(1, 65535));
+    std::string trace_file;
+    app.add_option("--trace-file", trace_file, "File a timeline of the last events of the pipeline threads is written to in the Chrome trace event format on exit and on SIGUSR1");
+    bool simulate = false;
+    app.add_flag("--simulate", simulate, "Replaces the device by a software simulation of its input and output streams");
+    std::vector<std::string> simulated_standard = { "1080p60" };
+    std::vector<std::string> simulated_standard_names = { "none" };
+    for (const auto& [ name, standard ] : Application::Backend::simulated_standards())
+        simulated_standard_names.push_back(name);
+    app.add_option("--simulated-standard", simulated_standard, "Video standard of the simulated input signal, or comma-separated list of standards it switches between, none being the loss of the signal")->delimiter(',')->check(CLI::IsMember(simulated_standard_names));
+    unsigned int simulated_switch_period_s = 5;
+    app.add_option("--simulated-switch-period", simulated_switch_period_s, "Period in seconds at which the simulated input signal switches to its next standard");
     CLI11_PARSE(app, argc, argv);
 
     const unsigned int number_of_slots = 16;
 
+    if (zero_copy && overlay_enabled)
+    {
+        std::cerr << "Zero-copy passthrough is not available with overlay" << std::endl;
+        return -1;
+    }
+    if (async_overlay && !overlay_enabled)
+    {
+        std::cerr << "Asynchronous overlay generation requires overlay" << std::endl;
+        return -1;
+    }
+    if (std::all_of(simulated_standard.begin(), simulated_standard.end(), [](const std::string& name) { return name == "none"; }))
+    {
+        std::cerr << "The simulated input signal requires at least one video standard" << std::endl;
+        return -1;
+    }
+
+    for (auto* thread_policy : { &rx_thread_policy, &tx_thread_policy, &renderer_thread_policy, &processing_thread_policy })
+        thread_policy->scheduling_policy = (scheduling_policy == "rr") ? Application::Threading::SchedulingPolicy::round_robin : Application::Threading::SchedulingPolicy::fifo;
+
+    std::vector<Channel> channels;
+    for (const auto& mapping : channel_mappings)
+    {
+        auto channel = parse_channel(mapping);
+        if (!channel)
+        {
+            std::cerr << "Invalid channel mapping " << mapping << ", expected device:input:output" << std::endl;
+            return -1;
+        }
+        for (const auto& other : channels)
+        {
+            if (other.device_id == channel->device_id && (other.rx_stream_id == channel->rx_stream_id || other.tx_stream_id == channel->tx_stream_id))
+            {
+                std::cerr << "Channel mapping " << mapping << " uses a connector of another channel" << std::endl;
+                return -1;
+            }
+        }
+        channels.push_back(*channel);
+    }
+    if (channels.empty())
+        channels.push_back({ device_id, rx_stream_id, tx_stream_id });
+
+    for (const auto& channel : channels)
+    {
+        auto& shared_resources = *channels_shared_resources.emplace_back(std::make_unique<Deltacast::SharedResources>());
+        shared_resources.preview_scale = preview_scale;
+        shared_resources.maximum_latency = maximum_latency;
+        shared_resources.frame_ring_depth = frame_ring_depth;
+        shared_resources.synchronization.configure_wakeup(low_latency_wakeup ? Application::Threading::Notifier::Mode::spin_then_block : Application::Threading::Notifier::Mode::blocking
+                                                        , std::chrono::microseconds(wakeup_spin_budget_us));
+        if (channels.size() > 1)
+            shared_resources.log_prefix = "[" + std::to_string(channel.device_id) + ":" + std::to_string(channel.rx_stream_id) + ":" + std::to_string(channel.tx_stream_id) + "] ";
+    }
+
     signal(SIGINT, on_close);
+    Application::Logging::start();
 
     std::cout << "VideoMaster overlay-from-live-content (" << VERSTRING << ")" << std::endl;
-    
+
+    if (!trace_file.empty() && Application::Tracing::start(trace_file))
+    {
+        std::cout << "Tracing the pipeline into " << trace_file << std::endl;
+#if defined(__linux__)
+        signal(SIGUSR1, on_dump_trace);
+#endif
+    }
+
+    std::vector<int> results(channels.size(), 0);
     try
     {    
         std::cout << "VideoMaster API version: " << api_version() << std::endl;
-        std::cout << "Discovered " << Board::count() << " devices" << std::endl;
+        std::cout << "Processing kernels: " << Application::Kernels::to_string(Application::Kernels::detect_instruction_set()) << std::endl;
 
-        if (device_id >= Board::count())
+        Application::Threading::check_privileges(std::max({ rx_thread_policy.priority, tx_thread_policy.priority, renderer_thread_policy.priority, processing_thread_policy.priority }), memory_locking);
+        if (memory_locking && Application::Threading::lock_memory())
+            std::cout << "Process memory locked" << std::endl;
+
+        std::vector<std::unique_ptr<Application::Backend::Device>> devices;
+        if (simulate)
         {
-            std::cout << "Invalid device ID" << std::endl;
-            return -1;
+            std::vector<std::optional<Application::Helper::DvSignalInformation>> standards;
+            std::string standard_names;
+            for (const auto& name : simulated_standard)
+            {
+                if (name == "none")
+                    standards.push_back(std::nullopt);
+                else
+                    standards.push_back(Application::Backend::simulated_standards().at(name));
+                standard_names += (standard_names.empty() ? "" : ", ") + name;
+            }
+            std::cout << "Simulating " << channels.size() << " device(s) with a " << standard_names << " input";
+            if (standards.size() > 1)
+                std::cout << " switching every " << simulated_switch_period_s << " s";
+            std::cout << std::endl;
+
+            auto signal = std::make_shared<const Application::Backend::SimulatedSignal>(standards, std::chrono::seconds(simulated_switch_period_s));
+            for (size_t i = 0; i < channels.size(); ++i)
+                devices.push_back(std::make_unique<Application::Backend::SimulatedDevice>(signal, number_of_slots));
         }
+        else
+        {
+            std::cout << "Discovered " << Board::count() << " devices" << std::endl;
 
-        std::cout << "Opening device " << device_id << std::endl;
-        auto board = Board::open(device_id, [&rx_stream_id](Board& board) { Application::Helper::enable_loopback(board, rx_stream_id); });
+            std::map<unsigned int, std::shared_ptr<Board>> boards;
+            std::map<unsigned int, std::shared_ptr<Application::Backend::BoardGenlock>> genlocks;
+            for (size_t i = 0; i < channels.size(); ++i)
+            {
+                const auto& channel = channels[i];
+                if (channel.device_id >= Board::count())
+                {
+                    std::cout << "Invalid device ID" << std::endl;
+                    return -1;
+                }
 
-        std::cout << board << std::endl;
+                auto& board = boards[channel.device_id];
+                if (!board)
+                {
+                    std::vector<unsigned int> board_rx_stream_ids;
+                    for (const auto& other : channels)
+                        if (other.device_id == channel.device_id)
+                            board_rx_stream_ids.push_back(other.rx_stream_id);
 
-        if (!board.has_keyer(tx_stream_id))
-        {
-            std::cerr << "Output connector " << tx_stream_id << " does not support keying" << std::endl;
-            return -1;
+                    std::cout << "Opening device " << channel.device_id << std::endl;
+                    board = std::make_shared<Board>(Board::open(channel.device_id, [board_rx_stream_ids](Board& board)
+                    {
+                        for (unsigned int board_rx_stream_id : board_rx_stream_ids)
+                            Application::Helper::enable_loopback(board, board_rx_stream_id);
+                    }));
+
+                    std::cout << *board << std::endl;
+                }
+
+                if (!board->has_keyer(channel.tx_stream_id))
+                {
+                    std::cerr << "Output connector " << channel.tx_stream_id << " does not support keying" << std::endl;
+                    return -1;
+                }
+
+                auto& genlock = genlocks[channel.device_id];
+                if (!genlock)
+                    genlock = std::make_shared<Application::Backend::BoardGenlock>(board);
+                auto device = std::make_unique<Application::Backend::HardwareDevice>(board, genlock, channel.rx_stream_id, channel.tx_stream_id, channels_shared_resources[i]->log_prefix.c_str());
+                if (device->has_genlock() && !genlock->claim(channel.rx_stream_id))
+                {
+                    std::cerr << "Channel mapping " << channel.device_id << ":" << channel.rx_stream_id << ":" << channel.tx_stream_id << " needs the genlock of device " << channel.device_id
+                              << ", which is already locked to input " << *genlock->source() << " by another channel" << std::endl;
+                    return -1;
+                }
+                devices.push_back(std::move(device));
+            }
         }
 
-        while (!shared_resources.synchronization.stop_is_requested)
+        Application::Threading::WorkerPool worker_pool((processing_threads > 0) ? std::optional<unsigned int>(processing_threads) : std::nullopt, processing_thread_policy);
+        std::cout << "Processing on " << worker_pool.concurrency() << " threads" << ((channels.size() > 1) ? " shared by " + std::to_string(channels.size()) + " channels" : "") << std::endl;
+
+        std::optional<unsigned int> numa_node = processing_thread_policy.cores.empty() ? std::nullopt : Application::Allocation::numa_node_of_core(processing_thread_policy.cores.front());
+        // Each channel keeps its own pool, since a pool frees its unused buffers to allocate ones of another size on a signal change
+        std::vector<std::unique_ptr<Application::Allocation::BufferPool>> buffer_pools;
+        for (size_t i = 0; i < channels.size(); ++i)
+            buffer_pools.push_back(std::make_unique<Application::Allocation::BufferPool>(huge_pages_enabled, numa_node));
+        if (numa_node)
+            std::cout << "Allocating frame buffers on NUMA node " << *numa_node << std::endl;
+
+        Application::Metrics::Channels metrics_channels;
+        for (size_t i = 0; i < channels.size(); ++i)
+            metrics_channels.emplace_back(std::to_string(channels[i].device_id) + ":" + std::to_string(channels[i].rx_stream_id) + ":" + std::to_string(channels[i].tx_stream_id)
+                                        , &channels_shared_resources[i]->metrics);
+        Application::Metrics::Exporter metrics_exporter(metrics_channels);
+        if (!metrics_file.empty() && metrics_exporter.start_file_export(metrics_file, 1s))
+            std::cout << "Exporting metrics to " << metrics_file << std::endl;
+        if (metrics_port > 0 && metrics_exporter.start_http_export(static_cast<uint16_t>(metrics_port)))
+            std::cout << "Serving metrics on http://127.0.0.1:" << metrics_port << "/metrics" << std::endl;
+
+        const PipelineSettings settings = { overlay_enabled, renderer_enabled, capture_formats.at(capture_format), zero_copy, quality_degradation, async_overlay
+                                          , rx_thread_policy, tx_thread_policy, renderer_thread_policy };
+        if (channels.size() == 1)
+            results[0] = run_channel(channels[0], *devices[0], settings, worker_pool, *buffer_pools[0], *channels_shared_resources[0]);
+        else
         {
-            shared_resources.reset();
+            std::vector<std::thread> channel_threads;
+            for (size_t i = 0; i < channels.size(); ++i)
+                channel_threads.emplace_back([&, i]{ results[i] = run_channel(channels[i], *devices[i], settings, worker_pool, *buffer_pools[i], *channels_shared_resources[i]); });
+            for (auto& channel_thread : channel_threads)
+                channel_thread.join();
+        }
+    }
+    catch (const ApiException& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << e.logs() << std::endl;
+    }
+    Application::Tracing::stop();
+    Application::Logging::stop();
+
+    for (int result : results)
+        if (result != 0)
+            return result;
+    return 0;
+}
+
+std::optional<Channel> parse_channel(const std::string& mapping)
+{
+    Channel channel;
+    char separators[2];
+    std::istringstream stream(mapping);
+    if (!(stream >> channel.device_id >> separators[0] >> channel.rx_stream_id >> separators[1] >> channel.tx_stream_id) || separators[0] != ':' || separators[1] != ':' || !stream.eof())
+        return std::nullopt;
+    return channel;
+}
+
+// Configures the streams of the channel for its input signal, then reconfigures them in place on every signal change until stopped, on the calling thread.
+// The pipeline threads, the renderer and the buffers are kept across signal changes, only paused while the streams are reconfigured.
+int run_channel(const Channel& channel, Application::Backend::Device& device, const PipelineSettings& settings, Application::Threading::WorkerPool& worker_pool
+              , Application::Allocation::BufferPool& buffer_pool, Deltacast::SharedResources& shared_resources)
+{
+    const std::string& prefix = shared_resources.log_prefix;
+    int result = 0;
 
-            std::cout << "Opening RX" << rx_stream_id << " stream..." << std::endl;
-            auto rx_tech_stream = Application::Helper::open_stream(board, Application::Helper::rx_index_to_streamtype(rx_stream_id));
-            auto& rx_stream = Application::Helper::to_base_stream(rx_tech_stream);
+    // Declared before the streams, so that they are closed before the buffers attached to them are released
+    std::unique_ptr<Application::Backend::ApplicationBuffers> application_buffers;
+    std::unique_ptr<Application::Backend::Stream> rx_stream, tx_stream;
+    std::unique_ptr<Application::Processing::Processor> processor;
+    std::unique_ptr<WindowedRenderer> renderer;
+    Application::Processing::FrameDescriptor rx_frame_descriptor = {}, tx_frame_descriptor = {}, preview_frame_descriptor = {};
+    std::optional<Application::Helper::SignalInformation> signal_information;
+    Application::Backend::SignalMonitor signal_monitor(device, shared_resources.synchronization);
+    Application::Backend::SignalEvent signal_event = Application::Backend::SignalEvent::none;
 
-            std::cout << "Waiting for signal..." << std::endl;
-            if (!Application::Helper::wait_for_input(board.rx(rx_stream_id), shared_resources.synchronization.stop_is_requested))
+    // Each pipeline thread runs its loop once per stream configuration, until the channel is stopped
+    std::vector<std::thread> pipeline_threads;
+    auto start_pipeline_thread = [&](const Application::Threading::ThreadPolicy& thread_policy, const std::string& role, std::function<void()> loop)
+    {
+        pipeline_threads.emplace_back([&shared_resources, &thread_policy, role, loop]
+        {
+            Application::Threading::apply(thread_policy, role);
+            Application::Tracing::name_thread(shared_resources.log_prefix + role);
+            Application::Logging::register_thread();
+            uint64_t generation = 0;
+            while (shared_resources.reconfiguration.wait_until_resumed(generation, shared_resources.synchronization.stop_is_requested))
             {
-                std::cerr << "Application has been stopped before any input was received." << std::endl;
-                return -1;
+                loop();
+                shared_resources.reconfiguration.notify_paused();
             }
+        });
+    };
+
+    auto& timings = shared_resources.configuration_timings;
+    try
+    {
+        using Clock = Application::Statistics::Clock;
+        timings.begin("Startup", Clock::now());
+        auto phase_start = Clock::now();
+        std::cout << prefix << "Opening RX" << channel.rx_stream_id << " stream..." << std::endl;
+        rx_stream = device.open_rx_stream();
+        timings.record("Open RX stream", phase_start);
+
+        // The TX stream and the keyer do not depend on the signal and are set up while waiting for it
+        std::cout << prefix << "Opening TX" << channel.tx_stream_id << " stream..." << std::endl;
+        if (settings.overlay_enabled)
+            std::cout << prefix << "Configuring keyer..." << std::endl;
+        std::future<void> tx_setup = std::async(std::launch::async, [&, start = Clock::now()]
+        {
+            tx_stream = device.open_tx_stream();
+            if (settings.overlay_enabled)
+                device.configure_keyer();
+            else
+                device.disable_keyer();
+            timings.record("Open TX stream and set keyer up", start);
+        });
 
-            auto signal_information = Application::Helper::detect_information(rx_tech_stream);
-            auto video_characteristics = Application::Helper::get_video_characteristics(signal_information);
-            std::cout << "Detected:" << std::endl;
-            Application::Helper::print_information(signal_information, "\t");
+        while (!shared_resources.synchronization.stop_is_requested)
+        {
+            shared_resources.reset();
 
-            std::unique_ptr<WindowedRenderer> renderer;
-            if (renderer_enabled)
+            phase_start = Clock::now();
+            std::cout << prefix << "Waiting for signal..." << std::endl;
+            if (!signal_monitor.wait_for_signal(*rx_stream))
             {
-                auto window_refresh_interval = 10ms;
-                renderer = std::make_unique<WindowedRenderer>("Live Content", video_characteristics.width / 2, video_characteristics.height / 2
-                                                        , window_refresh_interval.count(), shared_resources.synchronization.stop_is_requested);
-                std::cout << "Initializing live content rendering window..." << std::endl;
-                renderer->init(video_characteristics.width, video_characteristics.height, Deltacast::VideoViewer::InputFormat::bgr_444_8);
+                if (!signal_information)
+                {
+                    std::cerr << prefix << "Application has been stopped before any input was received." << std::endl;
+                    result = -1;
+                }
+                break;
             }
+            // Reconfiguration times after a loss of signal are measured from its return
+            if (signal_event == Application::Backend::SignalEvent::signal_lost)
+                timings.begin("Reconfiguration", Clock::now());
+            else
+                timings.record("Wait for signal", phase_start);
 
+            const auto previous_signal_information = signal_information;
+            signal_information = rx_stream->detect_information();
+            auto video_characteristics = Application::Helper::get_video_characteristics(*signal_information);
+            std::cout << prefix << "Detected:" << std::endl;
+            Application::Helper::print_information(*signal_information, prefix + "\t");
+            shared_resources.frame_period = std::chrono::nanoseconds(1s) / std::max(video_characteristics.framerate, 1u);
+            // The frame being processed and the one being captured account for the 2 frames of latency outside the TX buffer queue
+            shared_resources.latency_controller.configure(std::max(shared_resources.maximum_latency, 2u) - 2, shared_resources.frame_period);
+            // Each frame of the TX buffer queue target gives the processing one more frame period
+            shared_resources.processing_budget = shared_resources.frame_period * (shared_resources.latency_controller.target_filling() + 1);
             std::cout << std::endl;
 
-            if (board.has_sdi() && board.rx(rx_stream_id).has_sdi())
+            // Plus the frame lent to the renderer, whose buffer is not captured into until it is given back
+            const unsigned int number_of_application_buffers = shared_resources.frame_ring_depth + shared_resources.maximum_latency + 2 + (settings.renderer_enabled ? 1 : 0);
+            std::future<void> buffer_reservation;
+            if (settings.zero_copy && previous_signal_information)
             {
-                std::cout << "Configuring genlock..." << std::endl;
-                configure_genlock(board.sdi().genlock(0), std::get<Application::Helper::SdiSignalInformation>(signal_information));
-                std::cout << "Waiting for genlock locked..." << std::endl;
-                Application::Helper::wait_for_genlock(board.sdi().genlock(0), shared_resources.synchronization.stop_is_requested);
+                // The application buffers are bound to the slots of the streams, which are opened again to carry buffers of the new size
+                rx_stream.reset();
+                tx_stream.reset();
+                application_buffers.reset();
+                rx_stream = device.open_rx_stream();
+                tx_setup = std::async(std::launch::async, [&, start = Clock::now()]
+                {
+                    tx_stream = device.open_tx_stream();
+                    timings.record("Open TX stream", start);
+                });
             }
-            std::cout << std::endl;
+            else if (settings.zero_copy)
+            {
+                const uint32_t buffer_size = Application::Helper::get_frame_descriptor(*signal_information, Application::Helper::to_buffer_packing(settings.capture_pixel_format).value()).size();
+                buffer_reservation = std::async(std::launch::async, [&, buffer_size, start = Clock::now()]
+                {
+                    buffer_pool.reserve(number_of_application_buffers, buffer_size);
+                    timings.record("Allocate frame buffers", start);
+                });
+            }
+
+            phase_start = Clock::now();
+            std::cout << prefix << "Configuring RX stream..." << std::endl;
+            rx_frame_descriptor = device.configure_rx_stream(*rx_stream, *signal_information, settings.capture_pixel_format);
+            timings.record("Configure RX stream", phase_start);
 
-            if (overlay_enabled)
+            // The live content window only depends on the captured frames and is prepared while the genlock locks
+            std::future<bool> renderer_setup;
+            shared_resources.preview_enabled = settings.renderer_enabled;
+            if (settings.renderer_enabled)
             {
-                std::cout << "Configuring keyer..." << std::endl;
-                configure_keyer(board.keyer(tx_stream_id), rx_stream_id, tx_stream_id);
+                const auto previous_preview_frame_descriptor = preview_frame_descriptor;
+                preview_frame_descriptor = Application::Processing::downscaled(rx_frame_descriptor, shared_resources.preview_scale);
+                const int preview_width = static_cast<int>(preview_frame_descriptor.width), preview_height = static_cast<int>(preview_frame_descriptor.height);
+                if (!renderer)
+                {
+                    auto window_refresh_interval = 10ms;
+                    renderer = std::make_unique<WindowedRenderer>("Live Content " + prefix, preview_width, preview_height
+                                                            , window_refresh_interval.count(), shared_resources.synchronization.stop_is_requested, settings.renderer_thread_policy);
+                    std::cout << prefix << "Initializing live content rendering window..." << std::endl;
+                    renderer_setup = std::async(std::launch::async, [&, preview_width, preview_height, start = Clock::now()]
+                    {
+                        const bool initialized = renderer->init(preview_width, preview_height, Deltacast::VideoViewer::InputFormat::bgr_444_8);
+                        timings.record("Open live content window", start);
+                        return initialized;
+                    });
+                }
+                else if (preview_frame_descriptor != previous_preview_frame_descriptor)
+                {
+                    std::cout << prefix << "Resizing live content rendering..." << std::endl;
+                    renderer_setup = std::async(std::launch::async, [&, preview_width, preview_height, start = Clock::now()]
+                    {
+                        const bool resized = renderer->resize_image(preview_width, preview_height, Deltacast::VideoViewer::InputFormat::bgr_444_8);
+                        timings.record("Resize live content window", start);
+                        return resized;
+                    });
+                }
             }
-            else
-                board.keyer(tx_stream_id).disable();
-
-            std::cout << "Opening TX" << tx_stream_id << " stream..." << std::endl;
-            auto tx_tech_stream = Application::Helper::open_stream(board, Application::Helper::tx_index_to_streamtype(tx_stream_id));
-            auto& tx_stream = Application::Helper::to_base_stream(tx_tech_stream);
-                        
-            std::cout << "Configuring RX stream..." << std::endl;
-            configure_rx_stream(rx_tech_stream, signal_information, number_of_slots);
-            std::cout << "Starting RX stream..." << std::endl;
-            std::thread rx_thread(rx_loop, std::ref(rx_tech_stream), std::ref(shared_resources));
-
-            std::cout << "Configuring TX stream..." << std::endl;
-            configure_tx_stream(tx_tech_stream, signal_information, overlay_enabled, number_of_slots);
-            std::cout << "Starting TX stream..." << std::endl;
-            std::thread tx_thread(tx_loop, std::ref(board), std::ref(tx_tech_stream), (overlay_enabled ? Application::Processing::overlay : Application::Processing::non_overlay), std::ref(shared_resources));
-
-            if (renderer_enabled)
+
+            if (device.has_genlock() && (signal_event == Application::Backend::SignalEvent::genlock_lost || !previous_signal_information || !Application::Helper::same_genlock_reference(*previous_signal_information, *signal_information)))
             {
-                std::cout << "Starting live content rendering" << std::endl;
-                renderer->start(shared_resources);
+                phase_start = Clock::now();
+                std::cout << prefix << "Configuring genlock..." << std::endl;
+                device.configure_genlock(*signal_information);
+                std::cout << prefix << "Waiting for genlock locked..." << std::endl;
+                if (!signal_monitor.wait_for_genlock())
+                    break;
+                timings.record("Lock genlock", phase_start);
                 std::cout << std::endl;
             }
 
-            const uint32_t max_number_of_dots = 10;
-            uint32_t number_of_dots = 0;
-            while (!shared_resources.synchronization.stop_is_requested && !shared_resources.synchronization.incoming_signal_changed)
+            if (tx_setup.valid())
+                tx_setup.get();
+            phase_start = Clock::now();
+            std::cout << prefix << "Configuring TX stream..." << std::endl;
+            tx_frame_descriptor = device.configure_tx_stream(*tx_stream, *signal_information, settings.overlay_enabled ? Application::Processing::PixelFormat::rgba_32 : settings.capture_pixel_format);
+            timings.record("Configure TX stream", phase_start);
+
+            if (!processor || processor->input() != rx_frame_descriptor || processor->output() != tx_frame_descriptor)
             {
-                if (!Application::Helper::wait_for_input(board.rx(rx_stream_id), shared_resources.synchronization.stop_is_requested))
+                phase_start = Clock::now();
+                processor = Application::Processing::create_processor(settings.overlay_enabled, rx_frame_descriptor, tx_frame_descriptor, worker_pool);
+                if (!processor)
                 {
-                    std::this_thread::sleep_for(100ms);
-                    continue;
+                    result = -1;
+                    break;
                 }
-                if (Application::Helper::detect_information(rx_tech_stream) != signal_information)
+                shared_resources.quality_controller.configure(settings.quality_degradation ? processor->number_of_quality_levels() : 1);
+                timings.record("Create processor", phase_start);
+            }
+            if (settings.zero_copy)
+            {
+                if (buffer_reservation.valid())
+                    buffer_reservation.get();
+                phase_start = Clock::now();
+                application_buffers = std::make_unique<Application::Backend::ApplicationBuffers>(buffer_pool, number_of_application_buffers, tx_frame_descriptor.size());
+                rx_stream->attach_application_buffers(*application_buffers);
+                tx_stream->attach_application_buffers(*application_buffers);
+                timings.record("Attach frame buffers", phase_start);
+                std::cout << prefix << "Processing: zero-copy " << processor->name() << " through " << application_buffers->size() << " application buffers" << std::endl;
+            }
+            else if (settings.async_overlay)
+                std::cout << prefix << "Processing: asynchronous " << processor->name() << std::endl;
+            else
+                std::cout << prefix << "Processing: " << processor->name() << std::endl;
+            if (shared_resources.quality_controller.number_of_levels() > 1)
+                std::cout << prefix << "Processing quality levels: " << shared_resources.quality_controller.number_of_levels() << std::endl;
+
+            if (renderer_setup.valid() && !renderer_setup.get())
+            {
+                result = -1;
+                break;
+            }
+
+            if (pipeline_threads.empty())
+            {
+                start_pipeline_thread(settings.rx_thread_policy, "RX", [&]{ rx_loop(*rx_stream, rx_frame_descriptor, shared_resources); });
+                if (settings.async_overlay)
+                    start_pipeline_thread(settings.tx_thread_policy, "overlay generation", [&]{ overlay_loop(*processor, shared_resources); });
+                start_pipeline_thread(settings.tx_thread_policy, "TX", [&]
                 {
-                    shared_resources.synchronization.incoming_signal_changed = true;
-                    continue;
-                }
+                    if (settings.zero_copy)
+                        tx_loop_zero_copy(device, *tx_stream, *application_buffers, shared_resources);
+                    else if (settings.async_overlay)
+                        tx_loop_async_overlay(device, *tx_stream, tx_frame_descriptor, shared_resources);
+                    else
+                        tx_loop(device, *tx_stream, *processor, shared_resources);
+                });
+            }
 
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                std::cout << "\r" 
-                    << std::string(++number_of_dots, '.')
-                    << std::string(max_number_of_dots - number_of_dots, ' ')
-                    << std::flush;
+            std::cout << prefix << "Starting RX and TX streams..." << std::endl;
+            timings.expect_first_output_frame();
+            shared_resources.reconfiguration.resume(static_cast<unsigned int>(pipeline_threads.size()));
 
-                if (number_of_dots >= max_number_of_dots)
-                    number_of_dots = 0;
+            if (renderer && !previous_signal_information)
+            {
+                std::cout << prefix << "Starting live content rendering" << std::endl;
+                renderer->start(shared_resources);
+                std::cout << std::endl;
+            }
+
+            const auto statistics_period = 1s;
+            auto next_report = Clock::now() + statistics_period;
+            signal_event = Application::Backend::SignalEvent::none;
+            while (!shared_resources.synchronization.stop_is_requested && signal_event == Application::Backend::SignalEvent::none)
+            {
+                signal_event = signal_monitor.watch(*rx_stream, *signal_information, device.has_genlock(), shared_resources.frame_period, next_report);
+                // The TX thread only records when the first output frame went out, the phases are printed here
+                std::ostringstream timings_report;
+                if (timings.report_first_output_frame(timings_report, prefix))
+                    std::cout << std::endl << timings_report.str() << std::flush;
+                if (signal_event != Application::Backend::SignalEvent::none)
+                    timings.begin("Reconfiguration", Clock::now());
+                else if (Clock::now() >= next_report)
+                {
+                    // Printed at once so that the reports of concurrent channels do not interleave
+                    std::ostringstream report;
+                    report << std::endl << prefix << "Late frames: " << shared_resources.late_frames.exchange(0) << std::endl;
+                    if (settings.async_overlay)
+                        report << prefix << "Repeated overlays: " << shared_resources.repeated_overlays.exchange(0) << std::endl;
+                    else
+                    {
+                        const auto& latency_controller = shared_resources.latency_controller;
+                        const auto counters = latency_controller.counters();
+                        report << prefix << "Latency control: target TX filling " << latency_controller.target_filling()
+                               << ", predicted processing " << std::chrono::duration_cast<std::chrono::microseconds>(latency_controller.predicted_processing_time()).count() << " us"
+                               << ", frames processed " << counters.processed << ", skipped for queue depth " << counters.skipped_for_queue_depth
+                               << ", skipped for deadline " << counters.skipped_for_deadline << ", stale " << counters.stale << std::endl;
+                    }
+                    const auto& quality_controller = shared_resources.quality_controller;
+                    if (quality_controller.number_of_levels() > 1)
+                    {
+                        report << prefix << "Frames per quality level:";
+                        for (unsigned int level = 0; level < quality_controller.number_of_levels(); ++level)
+                            report << " " << level << ": " << quality_controller.frames_at_level(level);
+                        report << std::endl;
+                    }
+                    shared_resources.latency.print_and_reset(report);
+                    std::cout << report.str() << std::flush;
+                    next_report += statistics_period;
+                }
             }
             std::cout << std::endl;
 
-            rx_thread.join();
-            tx_thread.join();
+            if (shared_resources.synchronization.stop_is_requested)
+                break;
 
-            Application::Helper::enable_loopback(board, rx_stream_id);
+            std::cout << prefix << "Reconfiguring on " << Application::Backend::to_string(signal_event) << "..." << std::endl;
+            phase_start = Clock::now();
+            shared_resources.reconfiguration.wait_until_paused();
+            device.enable_loopback();
+            rx_stream->stop();
+            tx_stream->stop();
+            timings.record("Stop pipeline", phase_start);
         }
     }
     catch (const ApiException& e)
     {
-        std::cerr << e.what() << std::endl;
+        std::cerr << prefix << e.what() << std::endl;
         std::cerr << e.logs() << std::endl;
     }
+    catch (const std::bad_alloc&)
+    {
+        std::cout << prefix << "ERROR: Could not allocate the frame buffers" << std::endl;
+        result = -1;
+    }
 
-    return 0;
-}
-
-void configure_genlock(Deltacast::Wrapper::BoardComponents::SdiComponents::Genlock& genlock, const Application::Helper::SdiSignalInformation& sdi_signal_info)
-{
-    genlock.set_source(VHD_GENLOCK_RX0);
-    genlock.set_clock_divisor(sdi_signal_info.clock_divisor);
-    genlock.set_video_standard(sdi_signal_info.video_standard);
-}
-
-void configure_keyer(Deltacast::Wrapper::BoardComponents::Keyer& keyer, unsigned int rx_stream_id, unsigned int tx_stream_id)
-{
-    keyer.set_input_a(Application::Helper::rx_to_keyer_input(rx_stream_id));
-    keyer.set_input_b(Application::Helper::tx_to_keyer_input(tx_stream_id));
-    keyer.set_input_k(Application::Helper::tx_to_keyer_input(tx_stream_id));
-    keyer.set_video_output(VHD_KOUTPUT_KEYER);
-    keyer.set_alpha_clip_min_value(0);
-    keyer.set_alpha_clip_max_value(1020);
-    keyer.set_alpha_blend_factor(1023);
-    keyer.enable();
-}
-
+    shared_resources.synchronization.stop_is_requested = true;
+    for (auto& pipeline_thread : pipeline_threads)
+        pipeline_thread.join();
 
-void configure_rx_stream(Application::Helper::TechStream& rx_tech_stream, const Application::Helper::SignalInformation& signal_information, unsigned int number_of_slots)
-{
-    auto& rx_stream = Application::Helper::to_base_stream(rx_tech_stream);
+    const auto& ready_to_process_notifier = shared_resources.synchronization.ready_to_process_notifier();
+    const auto& processed_notifier = shared_resources.synchronization.processed_notifier();
+    std::cout << prefix << "Handoff waits: TX " << ready_to_process_notifier.number_of_waits() << " (" << ready_to_process_notifier.number_of_blocks() << " blocked)"
+              << ", RX " << processed_notifier.number_of_waits() << " (" << processed_notifier.number_of_blocks() << " blocked)" << std::endl;
 
-    rx_stream.buffer_queue().set_transfer_scheme(VHD_TRANSFER_UNCONSTRAINED);
-    rx_stream.set_buffer_packing(VHD_BUFPACK_VIDEO_RGB_24);
-    Application::Helper::configure_stream(rx_tech_stream, signal_information);
-}
+    renderer.reset();
+    device.enable_loopback();
 
-void configure_tx_stream(Application::Helper::TechStream& tx_tech_stream, const Application::Helper::SignalInformation& signal_information, bool overlay_enabled, unsigned int number_of_slots)
-{
-    auto& tx_stream = Application::Helper::to_base_stream(tx_tech_stream);
-
-    tx_stream.buffer_queue().set_preload(0);
-    tx_stream.set_buffer_packing(overlay_enabled ? VHD_BUFPACK_VIDEO_RGBA_32 : VHD_BUFPACK_VIDEO_RGB_24);
-    if (std::holds_alternative<SdiStream>(tx_tech_stream))
-        std::get<SdiStream>(tx_tech_stream).genlock().enable();
-    Application::Helper::configure_stream(tx_tech_stream, signal_information);
+    return result;
 }
 
-void check_for_drops(const Deltacast::Wrapper::StreamComponents::BufferQueue& buffer_queue, std::optional<unsigned int>& previous_slots_dropped, std::string name)
+void check_for_drops(Application::Backend::Stream& stream, std::optional<unsigned int>& previous_slots_dropped, Application::Metrics::StreamMetrics& metrics, const std::string& prefix, const char* name)
 {
-    unsigned int slots_count = buffer_queue.slots_count(), slots_dropped = buffer_queue.slots_dropped();
+    unsigned int slots_count = stream.slots_count(), slots_dropped = stream.slots_dropped();
+    metrics.slots_count.set(slots_count);
+    metrics.slots_dropped.set(slots_dropped);
+    metrics.buffer_queue_filling.set(stream.filling());
 
     if (!previous_slots_dropped.has_value())
         previous_slots_dropped = slots_dropped;
 
     if (previous_slots_dropped != slots_dropped)
     {
-        std::cout << "INFO for " << name << ": Dropped occurred: slots count=" << slots_count << ", slots dropped=" << slots_dropped << std::endl;
+        Application::Logging::log(Application::Logging::Event::slots_dropped, prefix.c_str(), name, slots_count, slots_dropped);
         previous_slots_dropped = slots_dropped;
     }
 }
 
-bool rx_loop(Application::Helper::TechStream& rx_tech_stream, Deltacast::SharedResources& shared_resources)
+bool rx_loop(Application::Backend::Stream& rx_stream, const Application::Processing::FrameDescriptor& frame_descriptor, Deltacast::SharedResources& shared_resources)
 {
-    auto& rx_stream = Application::Helper::to_base_stream(rx_tech_stream);
     try { rx_stream.start(); }
     catch (const ApiException& e)
     {
@@ -272,40 +732,91 @@ bool rx_loop(Application::Helper::TechStream& rx_tech_stream, Deltacast::SharedR
     }
 
     std::optional<unsigned int> previous_slots_dropped = std::nullopt;
+    std::vector<std::unique_ptr<Application::Backend::Slot>> in_flight_slots(shared_resources.frames.depth());
+    // The slot of the frame lent to the renderer is kept until the frame is taken back, which is waited for before any slot is released on exit
+    bool frame_lent = false;
+    unsigned int lent_index = 0;
+    std::unique_ptr<Application::Backend::Slot> lent_slot = nullptr;
+    struct PreviewTakeBack
+    {
+        Deltacast::SharedResources::PreviewLease& preview;
+        ~PreviewTakeBack() { preview.wait_until_taken_back(); }
+    } preview_take_back{ shared_resources.preview };
 
     while (!shared_resources.synchronization.stop_is_requested
-        && !shared_resources.synchronization.incoming_signal_changed)
+        && !shared_resources.synchronization.incoming_signal_changed())
     {
+        while (!shared_resources.synchronization.stop_is_requested
+            && !shared_resources.synchronization.incoming_signal_changed()
+            && !shared_resources.synchronization.wait_until_processed()) {}
+        if (shared_resources.synchronization.stop_is_requested
+            || shared_resources.synchronization.incoming_signal_changed())
+            break;
+
+        while (auto released_index = shared_resources.frames.reclaim())
+        {
+            if (frame_lent && !lent_slot && *released_index == lent_index)
+                lent_slot = std::move(in_flight_slots[*released_index]);
+            else
+                in_flight_slots[*released_index].reset();
+        }
+
+        std::unique_ptr<Application::Backend::Slot> slot = nullptr;
+        Application::Statistics::Clock::time_point slot_popped;
+        do
+        {
+            Application::Tracing::Span span("pop_slot");
+            std::unique_ptr<Application::Backend::Slot> popped_slot = nullptr;
+            try { popped_slot = rx_stream.pop_slot(); }
+            catch (const ApiException& e) { std::cout << shared_resources.log_prefix << "RX: " << e.what() << std::endl; return false; }
+
+            if (popped_slot)
+            {
+                slot = std::move(popped_slot);
+                slot_popped = Application::Statistics::Clock::now();
+            }
+            else
+                Application::Logging::log(Application::Logging::Event::timeout, shared_resources.log_prefix.c_str(), "RX");
+        } while (slot && rx_stream.filling() > 0);
+        if (!slot)
+            continue;
+
+        auto [ buffer, buffer_size ] = slot->buffer();
+        const unsigned int index = shared_resources.frames.next_index();
+        auto& frame = shared_resources.frames.next();
+        frame.buffer = buffer;
+        frame.buffer_size = buffer_size;
+        frame.timestamps.rx_slot_popped = slot_popped;
+        frame.timestamps.handed_off = Application::Statistics::Clock::now();
+        in_flight_slots[index] = std::move(slot);
+        shared_resources.synchronization.notify_ready_to_process();
+
+        // The renderer downscales the lent frame on its own thread, so that the capture never waits for the copy
+        if (shared_resources.preview_enabled)
         {
-            std::unique_ptr<Slot> slot = nullptr;
-            do
+            if (frame_lent && shared_resources.preview.take_back())
+            {
+                frame_lent = false;
+                lent_slot.reset();
+            }
+            if (!frame_lent && buffer_size >= frame_descriptor.size() && shared_resources.preview.lend({ buffer, frame_descriptor }))
             {
-                try { slot = rx_stream.pop_slot(); }
-                catch (const ApiException& e) { std::cout << "RX: " << e.what() << std::endl; if (e.error_code() == VHDERR_TIMEOUT) continue; else return false; }
-            } while (rx_stream.buffer_queue().filling() > 0);
-
-            auto& [ buffer, buffer_size ] = slot->video().buffer();
-            shared_resources.buffer = buffer;
-            shared_resources.buffer_size = buffer_size;
-
-            shared_resources.synchronization.notify_ready_to_process();
-            while (!shared_resources.synchronization.stop_is_requested
-                && !shared_resources.synchronization.incoming_signal_changed
-                && !shared_resources.synchronization.wait_until_processed()) {}
+                frame_lent = true;
+                lent_index = index;
+            }
         }
         
         if (!shared_resources.synchronization.stop_is_requested)
-            check_for_drops(rx_stream.buffer_queue(), previous_slots_dropped, "RX");
+            check_for_drops(rx_stream, previous_slots_dropped, shared_resources.metrics.rx, shared_resources.log_prefix, "RX");
     }
     
     return true;
 }
 
-bool tx_loop_processing(Application::Helper::TechStream& tx_tech_stream, Slot& slot, Application::Processing::Processor processor, Deltacast::SharedResources& shared_resources);
+bool tx_loop_processing(Application::Backend::Stream& tx_stream, Application::Backend::Slot& slot, Application::Processing::Processor& processor, Deltacast::SharedResources& shared_resources, Application::Statistics::FrameTimestamps& timestamps);
 
-bool tx_loop(Deltacast::Wrapper::Board& board, Application::Helper::TechStream& tx_tech_stream, Application::Processing::Processor processor, Deltacast::SharedResources& shared_resources)
+bool tx_loop(Application::Backend::Device& device, Application::Backend::Stream& tx_stream, Application::Processing::Processor& processor, Deltacast::SharedResources& shared_resources)
 {
-    auto& tx_stream = Application::Helper::to_base_stream(tx_tech_stream);
     try { tx_stream.start(); }
     catch (const ApiException& e)
     {
@@ -317,54 +828,270 @@ bool tx_loop(Deltacast::Wrapper::Board& board, Application::Helper::TechStream&
     std::optional<unsigned int> previous_slots_dropped = std::nullopt;
 
     while (!shared_resources.synchronization.stop_is_requested
-        && !shared_resources.synchronization.incoming_signal_changed)
+        && !shared_resources.synchronization.incoming_signal_changed())
     {
-        std::unique_ptr<Slot> slot = nullptr;
-        try { slot = tx_stream.pop_slot(); }
-        catch (const ApiException& e) { std::cout << "TX: " << e.what() << std::endl; if (e.error_code() == VHDERR_TIMEOUT) continue; else return false; }
+        std::unique_ptr<Application::Backend::Slot> slot = nullptr;
+        try { Application::Tracing::Span span("pop_slot"); slot = tx_stream.pop_slot(); }
+        catch (const ApiException& e) { std::cout << shared_resources.log_prefix << "TX: " << e.what() << std::endl; return false; }
+        if (!slot)
+        {
+            Application::Logging::log(Application::Logging::Event::timeout, shared_resources.log_prefix.c_str(), "TX");
+            continue;
+        }
 
-        bool success = tx_loop_processing(tx_tech_stream, *slot, processor, shared_resources);
-        shared_resources.synchronization.notify_processing_finished();
-        if (!success)
+        Application::Statistics::FrameTimestamps timestamps;
+        if (!tx_loop_processing(tx_stream, *slot, processor, shared_resources, timestamps))
             return false;
+        shared_resources.synchronization.notify_processing_finished();
+
+        slot.reset();
+        timestamps.tx_slot_released = Application::Statistics::Clock::now();
+        shared_resources.latency.record(timestamps);
+        shared_resources.metrics.record(timestamps);
+        shared_resources.configuration_timings.record_first_output_frame();
 
         if (!shared_resources.synchronization.stop_is_requested)
         {
             if (!previous_slots_dropped.has_value())
-                Application::Helper::disable_loopback(board, tx_stream.index(tx_stream.type()));
-            check_for_drops(tx_stream.buffer_queue(), previous_slots_dropped, "TX");
+                device.disable_loopback();
+            check_for_drops(tx_stream, previous_slots_dropped, shared_resources.metrics.tx, shared_resources.log_prefix, "TX");
         }
     }
 
     return true;
 }
 
-bool tx_loop_processing(Application::Helper::TechStream& tx_tech_stream, Slot& slot, Application::Processing::Processor processor, Deltacast::SharedResources& shared_resources)
+bool wait_until_ready_to_process(Deltacast::SharedResources& shared_resources)
 {
-    auto& tx_stream = Application::Helper::to_base_stream(tx_tech_stream);
-
+    Application::Tracing::Span span("wait_until_ready_to_process");
     while (!shared_resources.synchronization.stop_is_requested
-        && !shared_resources.synchronization.incoming_signal_changed
+        && !shared_resources.synchronization.incoming_signal_changed()
         && !shared_resources.synchronization.wait_until_ready_to_process()) {}
-    if (shared_resources.synchronization.stop_is_requested
-        || shared_resources.synchronization.incoming_signal_changed)
+
+    return !shared_resources.synchronization.stop_is_requested
+        && !shared_resources.synchronization.incoming_signal_changed();
+}
+
+bool wait_for_latest_frame(Application::Backend::Stream& tx_stream, Deltacast::SharedResources& shared_resources)
+{
+    Application::Tracing::Span span("wait_for_latest_frame");
+    auto& latency_controller = shared_resources.latency_controller;
+    while (true)
+    {
+        if (!wait_until_ready_to_process(shared_resources))
+            return false;
+
+        if (shared_resources.frames.pending() > 1)
+        {
+            latency_controller.record_stale(shared_resources.frames.pending() - 1);
+            shared_resources.metrics.stale_frames.increment(shared_resources.frames.pending() - 1);
+        }
+        while (shared_resources.frames.pending() > 1)
+            shared_resources.synchronization.notify_processing_finished();
+
+        const auto frame_age = Application::Statistics::Clock::now() - shared_resources.frames.front().timestamps.rx_slot_popped;
+        switch (latency_controller.decide(tx_stream.filling(), frame_age))
+        {
+            case Application::Control::LatencyController::Decision::process:
+                return true;
+            case Application::Control::LatencyController::Decision::skip_for_queue_depth:
+                shared_resources.metrics.frames_skipped_for_queue_depth.increment();
+                Application::Tracing::instant("skip for queue depth", "filling", tx_stream.filling());
+                break;
+            case Application::Control::LatencyController::Decision::skip_for_deadline:
+                shared_resources.metrics.frames_skipped_for_deadline.increment();
+                Application::Tracing::instant("skip for deadline", "age_us", std::chrono::duration_cast<std::chrono::microseconds>(frame_age).count());
+                break;
+        }
+
+        shared_resources.synchronization.notify_processing_finished();
+    }
+}
+
+void process_front_frame(Application::Processing::Processor& processor, uint8_t* buffer, uint32_t buffer_size, Deltacast::SharedResources& shared_resources, Application::Statistics::FrameTimestamps& timestamps)
+{
+    const auto& frame = shared_resources.frames.front();
+    timestamps = frame.timestamps;
+    timestamps.processing_started = Application::Statistics::Clock::now();
+    const auto deadline = frame.timestamps.rx_slot_popped + shared_resources.processing_budget;
+    processor.set_quality_level(shared_resources.quality_controller.select(deadline - timestamps.processing_started));
+    shared_resources.metrics.quality_level.set(processor.quality_level());
+    if (frame.buffer_size >= processor.input().size() && buffer_size >= processor.output().size())
+    {
+        Application::Tracing::Span span(processor.name(), "quality_level", processor.quality_level());
+        processor.process(frame.buffer, buffer, deadline);
+    }
+    else
+        Application::Logging::log(Application::Logging::Event::buffers_too_small, shared_resources.log_prefix.c_str(), "TX");
+    timestamps.processing_finished = Application::Statistics::Clock::now();
+    shared_resources.latency_controller.record_processing(timestamps.processing_finished - timestamps.processing_started);
+    shared_resources.quality_controller.record(processor.quality_level(), timestamps.processing_finished - timestamps.processing_started);
+    shared_resources.metrics.frames_processed.increment();
+    if (timestamps.processing_finished > deadline)
+    {
+        ++shared_resources.late_frames;
+        shared_resources.metrics.late_frames.increment();
+    }
+}
+
+bool tx_loop_processing(Application::Backend::Stream& tx_stream, Application::Backend::Slot& slot, Application::Processing::Processor& processor, Deltacast::SharedResources& shared_resources, Application::Statistics::FrameTimestamps& timestamps)
+{
+    if (!wait_for_latest_frame(tx_stream, shared_resources))
         return false;
 
-    auto buffer_queue_filling = tx_stream.buffer_queue().filling();
-    if (buffer_queue_filling > (shared_resources.maximum_latency - 2))
+    auto [ buffer, buffer_size ] = slot.buffer();
+    process_front_frame(processor, buffer, buffer_size, shared_resources, timestamps);
+
+    return true;
+}
+
+bool overlay_loop(Application::Processing::Processor& processor, Deltacast::SharedResources& shared_resources)
+{
+    while (wait_until_ready_to_process(shared_resources))
     {
-        for (auto i = 0; i < buffer_queue_filling - (shared_resources.maximum_latency - 2); ++i)
+        if (shared_resources.frames.pending() > 1)
         {
+            shared_resources.latency_controller.record_stale(shared_resources.frames.pending() - 1);
+            shared_resources.metrics.stale_frames.increment(shared_resources.frames.pending() - 1);
+        }
+        while (shared_resources.frames.pending() > 1)
             shared_resources.synchronization.notify_processing_finished();
-            while (!shared_resources.synchronization.stop_is_requested 
-                && !shared_resources.synchronization.incoming_signal_changed
-                && !shared_resources.synchronization.wait_until_ready_to_process()) {}
+
+        auto& overlay = shared_resources.overlays.back();
+        overlay.buffer.resize(processor.output().size());
+        process_front_frame(processor, overlay.buffer.data(), static_cast<uint32_t>(overlay.buffer.size()), shared_resources, overlay.timestamps);
+        shared_resources.overlays.publish();
+        shared_resources.synchronization.notify_processing_finished();
+    }
+
+    return true;
+}
+
+bool tx_loop_async_overlay(Application::Backend::Device& device, Application::Backend::Stream& tx_stream, const Application::Processing::FrameDescriptor& frame_descriptor, Deltacast::SharedResources& shared_resources)
+{
+    try { tx_stream.start(); }
+    catch (const ApiException& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << e.logs() << std::endl;
+        return false;
+    }
+
+    std::optional<unsigned int> previous_slots_dropped = std::nullopt;
+    bool overlay_available = false;
+    const auto polling_period = std::max(shared_resources.frame_period / 8, std::chrono::nanoseconds(100us));
+
+    while (!shared_resources.synchronization.stop_is_requested
+        && !shared_resources.synchronization.incoming_signal_changed())
+    {
+        // Without the RX cadence, the buffer queue itself paces the output so that it does not add latency
+        if (tx_stream.filling() > shared_resources.latency_controller.target_filling())
+        {
+            std::this_thread::sleep_for(polling_period);
+            continue;
+        }
+
+        std::unique_ptr<Application::Backend::Slot> slot = nullptr;
+        try { Application::Tracing::Span span("pop_slot"); slot = tx_stream.pop_slot(); }
+        catch (const ApiException& e) { std::cout << shared_resources.log_prefix << "TX: " << e.what() << std::endl; return false; }
+        if (!slot)
+        {
+            Application::Logging::log(Application::Logging::Event::timeout, shared_resources.log_prefix.c_str(), "TX");
+            continue;
+        }
+
+        const bool overlay_updated = shared_resources.overlays.wait_for_update(0ms);
+        overlay_available |= overlay_updated;
+        if (overlay_available && !overlay_updated)
+        {
+            ++shared_resources.repeated_overlays;
+            shared_resources.metrics.repeated_overlays.increment();
+        }
+
+        auto [ buffer, buffer_size ] = slot->buffer();
+        const auto& overlay = shared_resources.overlays.front();
+        // An overlay generated before a reconfiguration does not match the new output frame and is not keyed
+        const bool overlay_matches = overlay.buffer.size() == frame_descriptor.size() && overlay.buffer.size() <= buffer_size;
+        {
+            Application::Tracing::Span span("key overlay", "repeated", overlay_available && !overlay_updated);
+            if (overlay_available && overlay_matches)
+                memcpy(buffer, overlay.buffer.data(), overlay.buffer.size());
+            else
+                memset(buffer, 0, buffer_size);
+        }
+
+        slot.reset();
+        shared_resources.configuration_timings.record_first_output_frame();
+        if (overlay_updated && overlay_matches)
+        {
+            Application::Statistics::FrameTimestamps timestamps = overlay.timestamps;
+            timestamps.tx_slot_released = Application::Statistics::Clock::now();
+            shared_resources.latency.record(timestamps);
+            shared_resources.metrics.record(timestamps);
+        }
+
+        if (!shared_resources.synchronization.stop_is_requested)
+        {
+            if (!previous_slots_dropped.has_value())
+                device.disable_loopback();
+            check_for_drops(tx_stream, previous_slots_dropped, shared_resources.metrics.tx, shared_resources.log_prefix, "TX");
         }
     }
 
-    auto& [ buffer, buffer_size ] = slot.video().buffer();
+    return true;
+}
+
+bool tx_loop_zero_copy(Application::Backend::Device& device, Application::Backend::Stream& tx_stream, Application::Backend::ApplicationBuffers& application_buffers, Deltacast::SharedResources& shared_resources)
+{
+    try { tx_stream.start(); }
+    catch (const ApiException& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << e.logs() << std::endl;
+        return false;
+    }
+
+    std::optional<unsigned int> previous_slots_dropped = std::nullopt;
+
+    while (!shared_resources.synchronization.stop_is_requested
+        && !shared_resources.synchronization.incoming_signal_changed())
+    {
+        if (!wait_for_latest_frame(tx_stream, shared_resources))
+            return false;
 
-    processor(shared_resources.buffer, shared_resources.buffer_size, buffer, buffer_size);
+        const auto& frame = shared_resources.frames.front();
+        Application::Statistics::FrameTimestamps timestamps = frame.timestamps;
+        timestamps.processing_started = timestamps.processing_finished = Application::Statistics::Clock::now();
+
+        auto index = application_buffers.index_of(frame.buffer);
+        if (index)
+        {
+            Application::Tracing::Span span("send_application_buffer");
+            tx_stream.send_application_buffer(*index);
+        }
+        else
+        {
+            Application::Logging::log(Application::Logging::Event::unknown_buffer, shared_resources.log_prefix.c_str(), "TX");
+            shared_resources.metrics.frames_not_sent.increment();
+        }
+        shared_resources.synchronization.notify_processing_finished();
+        tx_stream.collect_sent_application_buffers();
+
+        if (index)
+        {
+            timestamps.tx_slot_released = Application::Statistics::Clock::now();
+            shared_resources.latency.record(timestamps);
+            shared_resources.metrics.record(timestamps);
+            shared_resources.configuration_timings.record_first_output_frame();
+        }
+
+        if (!shared_resources.synchronization.stop_is_requested)
+        {
+            if (!previous_slots_dropped.has_value())
+                device.disable_loopback();
+            check_for_drops(tx_stream, previous_slots_dropped, shared_resources.metrics.tx, shared_resources.log_prefix, "TX");
+        }
+    }
 
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,224 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Application::Metrics
+{
+    void DurationHistogram::record(Statistics::Clock::duration duration)
+    {
+        const double duration_s = std::chrono::duration<double>(duration).count();
+        const auto bucket = std::lower_bound(upper_bounds_s.begin(), upper_bounds_s.end(), duration_s) - upper_bounds_s.begin();
+        _counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        _sum_ns.fetch_add(static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0)), std::memory_order_relaxed);
+    }
+
+    double DurationHistogram::sum_s() const
+    {
+        return _sum_ns.load(std::memory_order_relaxed) / 1e9;
+    }
+
+    void ChannelMetrics::record(const Statistics::FrameTimestamps& timestamps)
+    {
+        handoff_wait.record(timestamps.processing_started - timestamps.handed_off);
+        processing_time.record(timestamps.processing_finished - timestamps.processing_started);
+    }
+
+    namespace
+    {
+        const std::string metric_prefix = "videomaster_overlay_";
+
+        template <typename Value>
+        void write_family(std::ostream& os, const Channels& channels, const std::string& name, const char* type, const char* help, Value value)
+        {
+            os << "# HELP " << metric_prefix << name << " " << help << "\n";
+            os << "# TYPE " << metric_prefix << name << " " << type << "\n";
+            for (const auto& [ channel, metrics ] : channels)
+                os << metric_prefix << name << "{channel=\"" << channel << "\"} " << value(*metrics) << "\n";
+        }
+
+        void write_histogram(std::ostream& os, const Channels& channels, const std::string& name, const char* help, DurationHistogram ChannelMetrics::* histogram)
+        {
+            os << "# HELP " << metric_prefix << name << " " << help << "\n";
+            os << "# TYPE " << metric_prefix << name << " histogram\n";
+            for (const auto& [ channel, metrics ] : channels)
+            {
+                const DurationHistogram& durations = metrics->*histogram;
+                uint64_t count = 0;
+                for (unsigned int bucket = 0; bucket < DurationHistogram::upper_bounds_s.size(); ++bucket)
+                {
+                    count += durations.count(bucket);
+                    os << metric_prefix << name << "_bucket{channel=\"" << channel << "\",le=\"" << DurationHistogram::upper_bounds_s[bucket] << "\"} " << count << "\n";
+                }
+                count += durations.count(DurationHistogram::upper_bounds_s.size());
+                os << metric_prefix << name << "_bucket{channel=\"" << channel << "\",le=\"+Inf\"} " << count << "\n";
+                os << metric_prefix << name << "_sum{channel=\"" << channel << "\"} " << durations.sum_s() << "\n";
+                os << metric_prefix << name << "_count{channel=\"" << channel << "\"} " << count << "\n";
+            }
+        }
+    }
+
+    void write_prometheus(std::ostream& os, const Channels& channels)
+    {
+        for (const auto& [ direction, stream ] : { std::make_pair("rx", &ChannelMetrics::rx), std::make_pair("tx", &ChannelMetrics::tx) })
+        {
+            const std::string name = direction;
+            write_family(os, channels, name + "_slots_count", "gauge", "Slots transferred by the stream since it was started", [stream = stream](const ChannelMetrics& metrics) { return (metrics.*stream).slots_count.value(); });
+            write_family(os, channels, name + "_slots_dropped", "gauge", "Slots dropped by the stream since it was started", [stream = stream](const ChannelMetrics& metrics) { return (metrics.*stream).slots_dropped.value(); });
+            write_family(os, channels, name + "_buffer_queue_filling", "gauge", "Slots in the buffer queue of the stream", [stream = stream](const ChannelMetrics& metrics) { return (metrics.*stream).buffer_queue_filling.value(); });
+        }
+        write_family(os, channels, "frames_processed_total", "counter", "Frames processed", [](const ChannelMetrics& metrics) { return metrics.frames_processed.value(); });
+        write_family(os, channels, "frames_skipped_for_queue_depth_total", "counter", "Frames skipped to bring the TX buffer queue back to its target", [](const ChannelMetrics& metrics) { return metrics.frames_skipped_for_queue_depth.value(); });
+        write_family(os, channels, "frames_skipped_for_deadline_total", "counter", "Frames skipped ahead of a predicted deadline miss", [](const ChannelMetrics& metrics) { return metrics.frames_skipped_for_deadline.value(); });
+        write_family(os, channels, "stale_frames_total", "counter", "Frames replaced by a newer one before being considered for processing", [](const ChannelMetrics& metrics) { return metrics.stale_frames.value(); });
+        write_family(os, channels, "frames_not_sent_total", "counter", "Captured frames outside of the application buffers in zero-copy mode, which could not be sent", [](const ChannelMetrics& metrics) { return metrics.frames_not_sent.value(); });
+        write_family(os, channels, "late_frames_total", "counter", "Frames whose processing finished after their deadline", [](const ChannelMetrics& metrics) { return metrics.late_frames.value(); });
+        write_family(os, channels, "repeated_overlays_total", "counter", "Output frames keyed with an overlay that had already been keyed", [](const ChannelMetrics& metrics) { return metrics.repeated_overlays.value(); });
+        write_family(os, channels, "processing_quality_level", "gauge", "Quality level of the last processed frame, 0 being the full quality", [](const ChannelMetrics& metrics) { return metrics.quality_level.value(); });
+        write_histogram(os, channels, "handoff_wait_seconds", "Time between the handoff of a captured frame and the start of its processing", &ChannelMetrics::handoff_wait);
+        write_histogram(os, channels, "processing_time_seconds", "Processing time of a frame", &ChannelMetrics::processing_time);
+    }
+
+    Exporter::Exporter(Channels channels)
+        : _channels(std::move(channels))
+    {
+    }
+
+    Exporter::~Exporter()
+    {
+        stop();
+    }
+
+    bool Exporter::start_file_export(const std::string& path, std::chrono::milliseconds period)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR: Cannot write metrics to " << path << std::endl;
+            return false;
+        }
+
+        _threads.emplace_back(&Exporter::export_to_file, this, path, period);
+        return true;
+    }
+
+    bool Exporter::start_http_export(uint16_t port)
+    {
+    #if defined(__linux__)
+        const int server_socket = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse_address = 1;
+        setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (server_socket < 0 || bind(server_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(server_socket, 4) != 0)
+        {
+            std::cout << "ERROR: Cannot serve metrics on 127.0.0.1:" << port << " (" << strerror(errno) << ")" << std::endl;
+            if (server_socket >= 0)
+                close(server_socket);
+            return false;
+        }
+
+        _threads.emplace_back(&Exporter::serve_http, this, server_socket);
+        return true;
+    #else
+        (void)port;
+        std::cout << "WARNING: Serving metrics over HTTP is not supported on this platform" << std::endl;
+        return false;
+    #endif
+    }
+
+    void Exporter::stop()
+    {
+        _stop = true;
+        for (auto& thread : _threads)
+            thread.join();
+        _threads.clear();
+    }
+
+    void Exporter::export_to_file(std::string path, std::chrono::milliseconds period)
+    {
+        const std::string temporary_path = path + ".tmp";
+        while (!_stop)
+        {
+            {
+                std::ofstream file(temporary_path, std::ios::trunc);
+                write_prometheus(file, _channels);
+            }
+            std::rename(temporary_path.c_str(), path.c_str());
+
+            for (auto waited = std::chrono::milliseconds(0); waited < period && !_stop; waited += std::chrono::milliseconds(100))
+                std::this_thread::sleep_for(std::min(period - waited, std::chrono::milliseconds(100)));
+        }
+    }
+
+    void Exporter::serve_http(int server_socket)
+    {
+    #if defined(__linux__)
+        while (!_stop)
+        {
+            pollfd server_poll = { server_socket, POLLIN, 0 };
+            if (poll(&server_poll, 1, 100) <= 0)
+                continue;
+
+            const int client_socket = accept(server_socket, nullptr, nullptr);
+            if (client_socket < 0)
+                continue;
+
+            // Any request gets the metrics, its content is read and ignored
+            pollfd client_poll = { client_socket, POLLIN, 0 };
+            char request[1024];
+            if (poll(&client_poll, 1, 100) > 0)
+                (void)recv(client_socket, request, sizeof(request), 0);
+
+            std::ostringstream body;
+            write_prometheus(body, _channels);
+            const std::string content = body.str();
+            std::ostringstream response;
+            response << "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " << content.size() << "\r\nConnection: close\r\n\r\n" << content;
+            const std::string message = response.str();
+            for (size_t sent = 0; sent < message.size();)
+            {
+                const ssize_t result = send(client_socket, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+                if (result <= 0)
+                    break;
+                sent += static_cast<size_t>(result);
+            }
+            close(client_socket);
+        }
+        close(server_socket);
+    #else
+        (void)server_socket;
+    #endif
+    }
+}
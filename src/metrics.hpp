@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "statistics.hpp"
+
+namespace Application::Metrics
+{
+    // Metrics are updated with relaxed atomics by the pipeline threads and read by the exporter without any lock
+
+    class Counter
+    {
+    public:
+        void increment(uint64_t value = 1) { _value.fetch_add(value, std::memory_order_relaxed); }
+        uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> _value = 0;
+    };
+
+    class Gauge
+    {
+    public:
+        void set(int64_t value) { _value.store(value, std::memory_order_relaxed); }
+        int64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> _value = 0;
+    };
+
+    // Durations counted into fixed buckets from 100 us to 100 ms
+    class DurationHistogram
+    {
+    public:
+        static constexpr std::array<double, 10> upper_bounds_s = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1 };
+
+        void record(Statistics::Clock::duration duration);
+        // Number of durations of each bucket, the last one counting those above the highest bound
+        uint64_t count(unsigned int bucket) const { return _counts[bucket].load(std::memory_order_relaxed); }
+        double sum_s() const;
+
+    private:
+        std::array<std::atomic<uint64_t>, upper_bounds_s.size() + 1> _counts = {};
+        std::atomic<uint64_t> _sum_ns = 0;
+    };
+
+    struct StreamMetrics
+    {
+        Gauge slots_count;
+        Gauge slots_dropped;
+        Gauge buffer_queue_filling;
+    };
+
+    struct ChannelMetrics
+    {
+        StreamMetrics rx;
+        StreamMetrics tx;
+
+        Counter frames_processed;
+        Counter frames_skipped_for_queue_depth;
+        Counter frames_skipped_for_deadline;
+        Counter stale_frames;
+        Counter frames_not_sent;
+        Counter late_frames;
+        Counter repeated_overlays;
+        Gauge quality_level;
+
+        DurationHistogram handoff_wait;
+        DurationHistogram processing_time;
+
+        // Records the handoff wait and the processing time of a frame
+        void record(const Statistics::FrameTimestamps& timestamps);
+    };
+
+    using Channels = std::vector<std::pair<std::string, const ChannelMetrics*>>;
+
+    // Writes the metrics of the channels, labeled with their name, in the Prometheus text exposition format
+    void write_prometheus(std::ostream& os, const Channels& channels);
+
+    // Exports the metrics to a file rewritten at every period, or serves them over HTTP on the loopback interface
+    class Exporter
+    {
+    public:
+        explicit Exporter(Channels channels);
+        ~Exporter();
+
+        Exporter(const Exporter&) = delete;
+        Exporter& operator=(const Exporter&) = delete;
+
+        // The file is written next to its path and renamed so that readers never see a partial file
+        bool start_file_export(const std::string& path, std::chrono::milliseconds period);
+        bool start_http_export(uint16_t port);
+        void stop();
+
+    private:
+        Channels _channels;
+        std::atomic_bool _stop = false;
+        std::vector<std::thread> _threads;
+
+        void export_to_file(std::string path, std::chrono::milliseconds period);
+        void serve_http(int server_socket);
+    };
+}
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "notifier.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#elif !defined(__APPLE__)
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace Application::Threading
+{
+    void Notifier::configure(Mode mode, std::chrono::microseconds spin_budget)
+    {
+        _mode = mode;
+        _spin_budget = spin_budget;
+    }
+
+    void Notifier::notify()
+    {
+        if (_mode == Mode::blocking)
+        {
+            {
+                std::lock_guard lock(_mutex);
+            }
+            _condition_variable.notify_one();
+            return;
+        }
+
+        _sequence.fetch_add(1, std::memory_order_seq_cst);
+        if (_number_of_sleepers.load(std::memory_order_seq_cst) == 0)
+            return;
+
+    #if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_sequence), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    #elif !defined(__APPLE__)
+        WakeByAddressSingle(&_sequence);
+    #endif
+    }
+
+    uint64_t Notifier::number_of_waits() const
+    {
+        return _number_of_waits;
+    }
+
+    uint64_t Notifier::number_of_blocks() const
+    {
+        return _number_of_blocks;
+    }
+
+    void Notifier::pause()
+    {
+    #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+    #else
+        std::this_thread::yield();
+    #endif
+    }
+
+    void Notifier::block(uint32_t sequence, std::chrono::microseconds timeout)
+    {
+        ++_number_of_sleepers;
+        if (_sequence.load(std::memory_order_seq_cst) == sequence)
+        {
+        #if defined(__linux__)
+            timespec relative_timeout;
+            relative_timeout.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+            relative_timeout.tv_nsec = static_cast<long>((timeout.count() % 1000000) * 1000);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_sequence), FUTEX_WAIT_PRIVATE, sequence, &relative_timeout, nullptr, 0);
+        #elif !defined(__APPLE__)
+            WaitOnAddress(&_sequence, &sequence, sizeof(sequence), static_cast<DWORD>((timeout.count() + 999) / 1000));
+        #else
+            std::this_thread::sleep_for(std::min(timeout, std::chrono::microseconds(100)));
+        #endif
+        }
+        --_number_of_sleepers;
+    }
+}
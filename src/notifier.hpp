@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace Application::Threading
+{
+    // Wakes up a thread waiting for some state shared through atomics to change.
+    // In blocking mode, waiters sleep on a condition variable.
+    // In spin-then-block mode, waiters spin on a sequence counter for the spin budget before sleeping on it.
+    class Notifier
+    {
+    public:
+        enum class Mode
+        {
+            blocking,
+            spin_then_block,
+        };
+
+        void configure(Mode mode, std::chrono::microseconds spin_budget);
+
+        template <typename Predicate>
+        bool wait_for(std::chrono::milliseconds timeout, Predicate predicate)
+        {
+            ++_number_of_waits;
+
+            if (_mode == Mode::blocking)
+            {
+                std::unique_lock lock(_mutex);
+                if (predicate())
+                    return true;
+
+                ++_number_of_blocks;
+                return _condition_variable.wait_for(lock, timeout, predicate);
+            }
+
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            const auto spin_deadline = std::chrono::steady_clock::now() + _spin_budget;
+            for (unsigned int iteration = 0; ; ++iteration)
+            {
+                const uint32_t sequence = _sequence.load(std::memory_order_acquire);
+                if (predicate())
+                    return true;
+
+                if ((iteration % 64) != 0 || std::chrono::steady_clock::now() < spin_deadline)
+                {
+                    pause();
+                    continue;
+                }
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline)
+                    return predicate();
+
+                ++_number_of_blocks;
+                block(sequence, std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+            }
+        }
+
+        void notify();
+
+        uint64_t number_of_waits() const;
+        uint64_t number_of_blocks() const;
+
+    private:
+        Mode _mode = Mode::blocking;
+        std::chrono::microseconds _spin_budget = std::chrono::microseconds(0);
+
+        std::mutex _mutex;
+        std::condition_variable _condition_variable;
+
+        std::atomic<uint32_t> _sequence = 0;
+        std::atomic<uint32_t> _number_of_sleepers = 0;
+        std::atomic<uint64_t> _number_of_waits = 0;
+        std::atomic<uint64_t> _number_of_blocks = 0;
+
+        static void pause();
+        void block(uint32_t sequence, std::chrono::microseconds timeout);
+    };
+}
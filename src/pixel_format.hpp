@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Application::Processing
+{
+    // Component order in memory follows the VideoMaster packings: 8-bit RGB pixels are stored as B, G, R (, A)
+    enum class PixelFormat
+    {
+        unknown,
+        rgb_24,
+        rgba_32,
+        yuv_422_8,  // 4:2:2 8-bit, stored as U Y V Y
+        yuv_422_10, // 4:2:2 10-bit V210, 6 pixels in four 32-bit little-endian words
+        rgb_30,     // 4:4:4 10-bit, R, G and B on bits 20, 10 and 0 of a 32-bit little-endian word
+    };
+
+    // Smallest run of pixels that a line of the format can be cut into
+    struct PixelGroup
+    {
+        uint32_t pixels;
+        uint32_t bytes;
+    };
+
+    constexpr PixelGroup pixel_group(PixelFormat pixel_format)
+    {
+        switch (pixel_format)
+        {
+        case PixelFormat::rgb_24: return { 1, 3 };
+        case PixelFormat::rgba_32: return { 1, 4 };
+        case PixelFormat::yuv_422_8: return { 2, 4 };
+        case PixelFormat::yuv_422_10: return { 6, 16 };
+        case PixelFormat::rgb_30: return { 1, 4 };
+        default: return { 1, 0 };
+        }
+    }
+
+    // Bytes taken by a run of pixels, rounded up to whole pixel groups
+    constexpr uint32_t line_size(PixelFormat pixel_format, uint32_t number_of_pixels)
+    {
+        const PixelGroup group = pixel_group(pixel_format);
+        return (number_of_pixels + group.pixels - 1) / group.pixels * group.bytes;
+    }
+
+    // V210 lines are padded to a multiple of 128 bytes, other formats are packed
+    constexpr uint32_t line_stride(PixelFormat pixel_format, uint32_t width)
+    {
+        const uint32_t size = line_size(pixel_format, width);
+        return (pixel_format == PixelFormat::yuv_422_10) ? (size + 127) / 128 * 128 : size;
+    }
+
+    constexpr const char* to_string(PixelFormat pixel_format)
+    {
+        switch (pixel_format)
+        {
+        case PixelFormat::rgb_24: return "RGB 8-bit";
+        case PixelFormat::rgba_32: return "RGBA 8-bit";
+        case PixelFormat::yuv_422_8: return "YUV 4:2:2 8-bit";
+        case PixelFormat::yuv_422_10: return "YUV 4:2:2 10-bit";
+        case PixelFormat::rgb_30: return "RGB 10-bit";
+        default: return "unknown";
+        }
+    }
+}
@@ -14,49 +14,190 @@
  */
 
 #include "processing.hpp"
+#include "kernels.hpp"
 
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 #include <vector>
-#include <thread>
 
 namespace Application::Processing
 {
-    void overlay(const uint8_t* buffer, uint32_t buffer_size, uint8_t* overlay_buffer, uint32_t overlay_buffer_size)
+    void WrittenRegions::clear_stale(uint8_t* buffer, uint32_t buffer_size, uint32_t first_byte, uint32_t last_byte)
     {
-        auto generate = [] (const uint8_t* buffer, uint8_t* overlay_buffer, uint32_t first_pixel, uint32_t last_pixel)
+        Region& previous = _regions.try_emplace(buffer, Region{ buffer_size, 0, buffer_size }).first->second;
+        if (previous.buffer_size != buffer_size)
+            previous = { buffer_size, 0, buffer_size };
+
+        if (previous.first_byte < first_byte)
+            memset(buffer + previous.first_byte, 0, std::min(previous.last_byte, first_byte) - previous.first_byte);
+        if (previous.last_byte > last_byte)
         {
-            for (uint32_t i = first_pixel; i < last_pixel; ++i)
-            {
-                uint32_t pixel_index = i * 3;
-                uint32_t overlay_pixel_index = i * 4;
+            const uint32_t first_stale_byte = std::max(previous.first_byte, last_byte);
+            memset(buffer + first_stale_byte, 0, previous.last_byte - first_stale_byte);
+        }
+
+        previous.first_byte = first_byte;
+        previous.last_byte = last_byte;
+    }
+
+    void WrittenRegions::reset()
+    {
+        _regions.clear();
+    }
+
+    void Processor::configure(const FrameDescriptor& input, const FrameDescriptor& output)
+    {
+        _input = input;
+        _output = output;
+    }
+
+    void Processor::set_quality_level(unsigned int quality_level)
+    {
+        _quality_level = std::min(quality_level, number_of_quality_levels() - 1);
+    }
 
-                overlay_buffer[overlay_pixel_index + 0] = buffer[pixel_index + 0];
-                overlay_buffer[overlay_pixel_index + 1] = buffer[pixel_index + 1];
-                overlay_buffer[overlay_pixel_index + 2] = buffer[pixel_index + 2];
-                overlay_buffer[overlay_pixel_index + 3] = 0xFF;
+    OverlayProcessor::OverlayProcessor(Threading::WorkerPool& worker_pool)
+        : _worker_pool(worker_pool)
+    {
+    }
+
+    bool OverlayProcessor::accepts(const FrameDescriptor& input, const FrameDescriptor& output) const
+    {
+        return output.pixel_format == PixelFormat::rgba_32 && Conversions::find_conversion(input.pixel_format, output.pixel_format)
+                && input.width == output.width && input.height == output.height;
+    }
+
+    void OverlayProcessor::configure(const FrameDescriptor& input, const FrameDescriptor& output)
+    {
+        Processor::configure(input, output);
+        _written_regions.reset();
+        _convert = Conversions::find_conversion(input.pixel_format, output.pixel_format);
+
+        _first_line = output.height / 2;
+        const uint32_t number_of_lines = output.height - _first_line;
+        _number_of_partitions = std::max(1u, std::min(_worker_pool.concurrency(), number_of_lines));
+        _lines_per_partition = number_of_lines / _number_of_partitions;
+    }
+
+    void OverlayProcessor::process(const uint8_t* input_buffer, uint8_t* output_buffer, Threading::WorkerPool::Clock::time_point deadline)
+    {
+        _written_regions.clear_stale(output_buffer, _output.size(), _first_line * _output.line_stride, _output.size());
+
+        const bool packed = (_quality_level == 0) && (pixel_group(_input.pixel_format).pixels == 1) && (_input.line_stride == line_size(_input.pixel_format, _input.width))
+                            && (_output.line_stride == line_size(_output.pixel_format, _output.width));
+        const uint32_t line_step = 1u << _quality_level;
+        const uint32_t output_line_size = line_size(_output.pixel_format, _output.width);
+        _worker_pool.run(_number_of_partitions, [&](unsigned int partition)
+        {
+            const uint32_t first_line = _first_line + partition * _lines_per_partition;
+            const uint32_t last_line = (partition + 1 == _number_of_partitions) ? _output.height : first_line + _lines_per_partition;
+
+            const uint8_t* input_line = input_buffer + first_line * _input.line_stride;
+            uint8_t* output_line = output_buffer + first_line * _output.line_stride;
+            if (packed)
+                return _convert(input_line, output_line, (last_line - first_line) * _output.width);
+
+            for (uint32_t line = first_line; line < last_line; ++line, input_line += _input.line_stride, output_line += _output.line_stride)
+            {
+                if (line == first_line || (line - _first_line) % line_step == 0)
+                    _convert(input_line, output_line, _output.width);
+                else
+                    memcpy(output_line, output_line - _output.line_stride, output_line_size);
             }
-        };
+        }, deadline);
+    }
 
-        memset(overlay_buffer, 0, overlay_buffer_size);
+    bool PassthroughProcessor::accepts(const FrameDescriptor& input, const FrameDescriptor& output) const
+    {
+        return input.pixel_format != PixelFormat::unknown && input.pixel_format == output.pixel_format
+                && input.width == output.width && input.height == output.height;
+    }
 
-        const uint32_t number_of_pixels = buffer_size / 3;
-        const uint32_t starting_point = (number_of_pixels / 2);
-        const uint32_t number_of_pixels_to_process = (number_of_pixels / 2);
+    void PassthroughProcessor::process(const uint8_t* input_buffer, uint8_t* output_buffer, Threading::WorkerPool::Clock::time_point /*deadline*/)
+    {
+        if (_input.line_stride == _output.line_stride)
+        {
+            memcpy(output_buffer, input_buffer, _output.size());
+            return;
+        }
+
+        const uint32_t copied_size = line_size(_output.pixel_format, _output.width);
+        for (uint32_t line = 0; line < _output.height; ++line)
+            memcpy(output_buffer + line * _output.line_stride, input_buffer + line * _input.line_stride, copied_size);
+    }
 
-        const int number_of_partitions = 4;
-        const uint32_t partition_size = number_of_pixels_to_process / number_of_partitions;
+    FrameDescriptor downscaled(const FrameDescriptor& frame_descriptor, unsigned int factor)
+    {
+        const uint32_t width = frame_descriptor.width / factor;
+        return { width, frame_descriptor.height / factor, line_stride(PixelFormat::rgb_24, width), PixelFormat::rgb_24, frame_descriptor.field_order };
+    }
 
-        std::vector<std::thread> processors;
-        for (int i = 0; i < number_of_partitions; ++i)
-            processors.emplace_back(generate, buffer, overlay_buffer, starting_point + i * partition_size, starting_point + (i + 1) * partition_size);
+    void downscale(const FrameDescriptor& source_descriptor, const uint8_t* source, unsigned int factor, uint8_t* destination)
+    {
+        const FrameDescriptor destination_descriptor = downscaled(source_descriptor, factor);
+        const Conversions::ConvertLine convert = Conversions::find_conversion(source_descriptor.pixel_format, PixelFormat::rgb_24);
+        if (!convert)
+            return;
 
-        for (auto& processor : processors)
-            processor.join();
+        // Other formats are converted to RGB 8-bit one box of lines at a time
+        const bool converted = (source_descriptor.pixel_format != PixelFormat::rgb_24);
+        const uint32_t rgb_line_size = line_size(PixelFormat::rgb_24, source_descriptor.width);
+        thread_local std::vector<uint8_t> rgb_lines;
+        if (converted && rgb_lines.size() < rgb_line_size * factor)
+            rgb_lines.resize(rgb_line_size * factor);
+
+        // A 4x4 box is the 2x2 box of two 2x2-downscaled line pairs
+        thread_local std::vector<uint8_t> half_lines;
+        const uint32_t half_width = source_descriptor.width / 2;
+        if (factor == 4 && half_lines.size() < half_width * 3 * 2)
+            half_lines.resize(half_width * 3 * 2);
+
+        for (uint32_t line = 0; line < destination_descriptor.height; ++line)
+        {
+            const uint8_t* source_line = source + line * factor * source_descriptor.line_stride;
+            uint32_t source_stride = source_descriptor.line_stride;
+            uint8_t* destination_line = destination + line * destination_descriptor.line_stride;
+
+            if (converted)
+            {
+                for (unsigned int box_line = 0; box_line < factor; ++box_line)
+                    convert(source_line + box_line * source_stride, rgb_lines.data() + box_line * rgb_line_size, source_descriptor.width);
+                source_line = rgb_lines.data();
+                source_stride = rgb_line_size;
+            }
+
+            if (factor == 1)
+                memcpy(destination_line, source_line, destination_descriptor.line_stride);
+            else if (factor == 2)
+                Kernels::downscale_rgb_24(source_line, source_line + source_stride, destination_line, destination_descriptor.width);
+            else
+            {
+                uint8_t* top_half_line = half_lines.data();
+                uint8_t* bottom_half_line = half_lines.data() + half_width * 3;
+                Kernels::downscale_rgb_24(source_line, source_line + source_stride, top_half_line, half_width);
+                Kernels::downscale_rgb_24(source_line + 2 * source_stride, source_line + 3 * source_stride, bottom_half_line, half_width);
+                Kernels::downscale_rgb_24(top_half_line, bottom_half_line, destination_line, destination_descriptor.width);
+            }
+        }
     }
 
-    void non_overlay(const uint8_t* buffer, uint32_t buffer_size, uint8_t* output_buffer, uint32_t output_buffer_size)
+    std::unique_ptr<Processor> create_processor(bool overlay_enabled, const FrameDescriptor& input, const FrameDescriptor& output, Threading::WorkerPool& worker_pool)
     {
-        memcpy(output_buffer, buffer, output_buffer_size);
+        std::unique_ptr<Processor> processor;
+        if (overlay_enabled)
+            processor = std::make_unique<OverlayProcessor>(worker_pool);
+        else
+            processor = std::make_unique<PassthroughProcessor>();
+
+        if (!processor->accepts(input, output))
+        {
+            std::cout << "ERROR: The " << processor->name() << " processing does not support " << to_string(input.pixel_format) << " " << input.width << "x" << input.height
+                      << " to " << to_string(output.pixel_format) << " " << output.width << "x" << output.height << std::endl;
+            return nullptr;
+        }
+
+        processor->configure(input, output);
+        return processor;
     }
-}
\ No newline at end of file
+}
@@ -16,12 +16,127 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "conversions.hpp"
+#include "pixel_format.hpp"
+#include "worker_pool.hpp"
 
 namespace Application::Processing
 {
-    using Processor = std::function<void(const uint8_t*, uint32_t, uint8_t*, uint32_t)>;
+    // Interlaced frames interleave their two fields line by line, the first field in time being on the top or the bottom line
+    enum class FieldOrder
+    {
+        progressive,
+        top_field_first,
+        bottom_field_first,
+    };
+
+    struct FrameDescriptor
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t line_stride;
+        PixelFormat pixel_format;
+        FieldOrder field_order;
+
+        uint32_t size() const { return line_stride * height; }
+        bool interlaced() const { return field_order != FieldOrder::progressive; }
+
+        bool operator==(const FrameDescriptor& other) const
+        {
+            return width == other.width
+                    && height == other.height
+                    && line_stride == other.line_stride
+                    && pixel_format == other.pixel_format
+                    && field_order == other.field_order;
+        }
+        bool operator!=(const FrameDescriptor& other) const { return !(*this == other); }
+    };
+
+    // Keeps track of the bytes written in each recycled output buffer so that only stale content needs clearing on reuse
+    class WrittenRegions
+    {
+    public:
+        void clear_stale(uint8_t* buffer, uint32_t buffer_size, uint32_t first_byte, uint32_t last_byte);
+        void reset();
+
+    private:
+        struct Region
+        {
+            uint32_t buffer_size;
+            uint32_t first_byte;
+            uint32_t last_byte;
+        };
+        std::unordered_map<const uint8_t*, Region> _regions;
+    };
+
+    // Transforms an input frame into an output frame whose layouts are fixed when the streams are configured
+    class Processor
+    {
+    public:
+        virtual ~Processor() = default;
+
+        virtual const char* name() const = 0;
+        virtual bool accepts(const FrameDescriptor& input, const FrameDescriptor& output) const = 0;
+        virtual void configure(const FrameDescriptor& input, const FrameDescriptor& output);
+
+        // Buffers must be at least as large as the configured descriptors.
+        // The deadline orders the work of concurrent pipelines on the shared worker pool.
+        virtual void process(const uint8_t* input_buffer, uint8_t* output_buffer, Threading::WorkerPool::Clock::time_point deadline) = 0;
+
+        // Processors may provide cheaper ways of processing a frame, level 0 being the full quality one
+        virtual unsigned int number_of_quality_levels() const { return 1; }
+        void set_quality_level(unsigned int quality_level);
+        unsigned int quality_level() const { return _quality_level; }
+
+        const FrameDescriptor& input() const { return _input; }
+        const FrameDescriptor& output() const { return _output; }
+
+    protected:
+        FrameDescriptor _input = {};
+        FrameDescriptor _output = {};
+        unsigned int _quality_level = 0;
+    };
+
+    // Copies the bottom half of the input frame into an RGBA overlay and leaves the top half transparent.
+    // Any capture format with a conversion to RGBA 8-bit is accepted, so the keyed overlay does not depend on it.
+    // Quality level N converts one line out of 2^N and repeats it over the next ones.
+    class OverlayProcessor : public Processor
+    {
+    public:
+        explicit OverlayProcessor(Threading::WorkerPool& worker_pool);
+
+        const char* name() const override { return "overlay"; }
+        bool accepts(const FrameDescriptor& input, const FrameDescriptor& output) const override;
+        void configure(const FrameDescriptor& input, const FrameDescriptor& output) override;
+        void process(const uint8_t* input_buffer, uint8_t* output_buffer, Threading::WorkerPool::Clock::time_point deadline) override;
+        unsigned int number_of_quality_levels() const override { return 3; }
+
+    private:
+        Threading::WorkerPool& _worker_pool;
+        WrittenRegions _written_regions;
+        Conversions::ConvertLine _convert = nullptr;
+
+        uint32_t _first_line = 0;
+        uint32_t _lines_per_partition = 0;
+        unsigned int _number_of_partitions = 0;
+    };
+
+    // Copies the input frame as is into an output frame of the same pixel format
+    class PassthroughProcessor : public Processor
+    {
+    public:
+        const char* name() const override { return "passthrough"; }
+        bool accepts(const FrameDescriptor& input, const FrameDescriptor& output) const override;
+        void process(const uint8_t* input_buffer, uint8_t* output_buffer, Threading::WorkerPool::Clock::time_point deadline) override;
+    };
+
+    // Layout of a frame converted to RGB 8-bit and box-filtered by a factor of 1, 2 or 4 into a packed buffer
+    FrameDescriptor downscaled(const FrameDescriptor& frame_descriptor, unsigned int factor);
+    void downscale(const FrameDescriptor& source_descriptor, const uint8_t* source, unsigned int factor, uint8_t* destination);
 
-    void overlay(const uint8_t* buffer, uint32_t buffer_size, uint8_t* overlay_buffer, uint32_t overlay_buffer_size);
-    void non_overlay(const uint8_t* buffer, uint32_t buffer_size, uint8_t* output_buffer, uint32_t output_buffer_size);
+    // Returns the configured processor matching the requested mode and the stream layouts, or nullptr if none accepts them
+    std::unique_ptr<Processor> create_processor(bool overlay_enabled, const FrameDescriptor& input, const FrameDescriptor& output, Threading::WorkerPool& worker_pool);
 }
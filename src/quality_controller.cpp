@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "quality_controller.hpp"
+
+#include <algorithm>
+
+namespace Application::Control
+{
+    void QualityController::configure(unsigned int number_of_levels)
+    {
+        _number_of_levels = std::clamp(number_of_levels, 1u, maximum_number_of_levels);
+        _level = 0;
+        for (auto& processing_times : _processing_times)
+            processing_times.clear();
+        _frames_fitting = 0;
+        _current_upgrade_delay = upgrade_delay;
+        _upgrade_attempted = false;
+        for (auto& frames : _frames_at_level)
+            frames = 0;
+    }
+
+    unsigned int QualityController::select(Statistics::Clock::duration time_left)
+    {
+        if (_processing_times[_level].percentile(prediction_percentile) > time_left)
+        {
+            if (_upgrade_attempted)
+                _current_upgrade_delay = std::min(2 * _current_upgrade_delay, maximum_upgrade_delay);
+            _upgrade_attempted = false;
+            _frames_fitting = 0;
+
+            // Levels that have not run yet are assumed to fit
+            while (_level + 1 < _number_of_levels && _processing_times[_level].percentile(prediction_percentile) > time_left)
+                ++_level;
+        }
+        else
+        {
+            // An attempt that held for a whole delay succeeded
+            if (++_frames_fitting >= upgrade_delay && _upgrade_attempted)
+            {
+                _current_upgrade_delay = upgrade_delay;
+                _upgrade_attempted = false;
+            }
+
+            if (_level > 0 && _frames_fitting >= _current_upgrade_delay)
+            {
+                // The timings of the better level date from the pressure that made it degrade, they are measured again
+                --_level;
+                _processing_times[_level].clear();
+                _frames_fitting = 0;
+                _upgrade_attempted = true;
+            }
+        }
+
+        ++_frames_at_level[_level];
+        return _level;
+    }
+
+    void QualityController::record(unsigned int level, Statistics::Clock::duration processing_time)
+    {
+        if (level < _number_of_levels)
+            _processing_times[level].record(processing_time);
+    }
+
+    uint64_t QualityController::frames_at_level(unsigned int level) const
+    {
+        return (level < maximum_number_of_levels) ? _frames_at_level[level].load() : 0;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "statistics.hpp"
+
+namespace Application::Control
+{
+    // Picks the quality level a processor runs at for each frame, level 0 being the full quality one and higher levels being cheaper.
+    // The level is lowered as soon as its predicted processing time no longer fits the time left before the deadline of the frame,
+    // and a better level is tried again after a run of frames that fit, waiting twice as long after each failed attempt.
+    // Levels are selected by the TX thread only, their counters can be read from any thread.
+    class QualityController
+    {
+    public:
+        static constexpr unsigned int maximum_number_of_levels = 4;
+        static constexpr unsigned int prediction_percentile = 90;
+        static constexpr unsigned int upgrade_delay = 30;
+        static constexpr unsigned int maximum_upgrade_delay = 16 * upgrade_delay;
+
+        void configure(unsigned int number_of_levels);
+
+        unsigned int select(Statistics::Clock::duration time_left);
+        void record(unsigned int level, Statistics::Clock::duration processing_time);
+
+        unsigned int number_of_levels() const { return _number_of_levels; }
+        uint64_t frames_at_level(unsigned int level) const;
+
+    private:
+        unsigned int _number_of_levels = 1;
+        unsigned int _level = 0;
+        std::array<Statistics::TimingWindow, maximum_number_of_levels> _processing_times;
+
+        unsigned int _frames_fitting = 0;
+        unsigned int _current_upgrade_delay = upgrade_delay;
+        bool _upgrade_attempted = false;
+
+        std::array<std::atomic<uint64_t>, maximum_number_of_levels> _frames_at_level = {};
+    };
+}
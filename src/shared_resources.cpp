@@ -15,49 +15,198 @@
 
 #include "shared_resources.hpp"
 
+void Deltacast::SharedResources::FrameRing::reset(unsigned int depth)
+{
+    _frames.assign(std::max(depth, 1u), Frame{});
+    _published = 0;
+    _released = 0;
+    _reclaimed = 0;
+}
+
+unsigned int Deltacast::SharedResources::FrameRing::depth() const
+{
+    return static_cast<unsigned int>(_frames.size());
+}
+
+Deltacast::SharedResources::Frame& Deltacast::SharedResources::FrameRing::next()
+{
+    return _frames[next_index()];
+}
+
+unsigned int Deltacast::SharedResources::FrameRing::next_index() const
+{
+    return static_cast<unsigned int>(_published.load(std::memory_order_relaxed) % _frames.size());
+}
+
+void Deltacast::SharedResources::FrameRing::publish()
+{
+    _published.fetch_add(1, std::memory_order_release);
+}
+
+std::optional<unsigned int> Deltacast::SharedResources::FrameRing::reclaim()
+{
+    const uint64_t reclaimed = _reclaimed.load(std::memory_order_relaxed);
+    if (reclaimed == _released.load(std::memory_order_acquire))
+        return std::nullopt;
+
+    _frames[reclaimed % _frames.size()] = Frame{};
+    _reclaimed.store(reclaimed + 1, std::memory_order_release);
+    return static_cast<unsigned int>(reclaimed % _frames.size());
+}
+
+unsigned int Deltacast::SharedResources::FrameRing::pending() const
+{
+    return static_cast<unsigned int>(_published.load(std::memory_order_acquire) - _released.load(std::memory_order_relaxed));
+}
+
+const Deltacast::SharedResources::Frame& Deltacast::SharedResources::FrameRing::front() const
+{
+    return _frames[_released.load(std::memory_order_relaxed) % _frames.size()];
+}
+
+void Deltacast::SharedResources::FrameRing::release()
+{
+    _released.fetch_add(1, std::memory_order_release);
+}
+
 bool Deltacast::SharedResources::Synchronization::wait_until_ready_to_process()
 {
     using namespace std::chrono_literals;
-    std::unique_lock lock(mutex);
-    return condition_variable.wait_for(lock, 100ms, [&]{ return to_process; });
+    return ready_to_process.wait_for(100ms, [&]{ return frames.pending() > 0 || incoming_signal_changed(); });
 }
 
 void Deltacast::SharedResources::Synchronization::notify_processing_finished()
 {
-    {
-        std::lock_guard lock(mutex);
-        processed = true;
-        to_process = false;
-    }
-    condition_variable.notify_one();
+    frames.release();
+    processed.notify();
 }
 
 bool Deltacast::SharedResources::Synchronization::wait_until_processed()
 {
     using namespace std::chrono_literals;
-    std::unique_lock lock(mutex);
-    return condition_variable.wait_for(lock, 100ms, [&]{ return processed; });
+    return processed.wait_for(100ms, [&]{ return frames.pending() < frames.depth() || incoming_signal_changed(); });
 }
 
 void Deltacast::SharedResources::Synchronization::notify_ready_to_process()
+{
+    frames.publish();
+    ready_to_process.notify();
+}
+
+void Deltacast::SharedResources::Synchronization::notify_signal_event(SignalEvent event)
+{
+    SignalEvent expected = SignalEvent::none;
+    signal_event.compare_exchange_strong(expected, event);
+    ready_to_process.notify();
+    processed.notify();
+}
+
+void Deltacast::SharedResources::Synchronization::configure_wakeup(Application::Threading::Notifier::Mode mode, std::chrono::microseconds spin_budget)
+{
+    ready_to_process.configure(mode, spin_budget);
+    processed.configure(mode, spin_budget);
+}
+
+const Application::Threading::Notifier& Deltacast::SharedResources::Synchronization::ready_to_process_notifier() const
+{
+    return ready_to_process;
+}
+
+const Application::Threading::Notifier& Deltacast::SharedResources::Synchronization::processed_notifier() const
+{
+    return processed;
+}
+
+bool Deltacast::SharedResources::Reconfiguration::wait_until_resumed(uint64_t& generation, const std::atomic_bool& stop_is_requested)
+{
+    using namespace std::chrono_literals;
+    std::unique_lock lock(_mutex);
+    while (!stop_is_requested && !_condition_variable.wait_for(lock, 100ms, [&]{ return _generation != generation; })) {}
+
+    generation = _generation;
+    return !stop_is_requested;
+}
+
+void Deltacast::SharedResources::Reconfiguration::notify_paused()
 {
     {
-        std::lock_guard lock(mutex);
-        processed = false;
-        to_process = true;
+        std::lock_guard lock(_mutex);
+        --_running_threads;
     }
-    condition_variable.notify_one();
+    _condition_variable.notify_all();
+}
+
+void Deltacast::SharedResources::Reconfiguration::resume(unsigned int number_of_threads)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _running_threads = number_of_threads;
+        ++_generation;
+    }
+    _condition_variable.notify_all();
+}
+
+void Deltacast::SharedResources::Reconfiguration::wait_until_paused()
+{
+    std::unique_lock lock(_mutex);
+    _condition_variable.wait(lock, [&]{ return _running_threads == 0; });
+}
+
+Deltacast::SharedResources::PreviewLease::PreviewLease()
+{
+    // The RX thread only pays for a wake-up system call when the renderer is actually asleep
+    _lent.configure(Application::Threading::Notifier::Mode::spin_then_block, std::chrono::microseconds(0));
+    _given_back.configure(Application::Threading::Notifier::Mode::spin_then_block, std::chrono::microseconds(0));
+}
+
+bool Deltacast::SharedResources::PreviewLease::lend(const LentFrame& frame)
+{
+    if (!take_back())
+        return false;
+
+    _frame = frame;
+    _state.store(State::lent, std::memory_order_release);
+    _lent.notify();
+    return true;
+}
+
+bool Deltacast::SharedResources::PreviewLease::take_back()
+{
+    State state = _state.load(std::memory_order_acquire);
+    if (state == State::lent && _state.compare_exchange_strong(state, State::available, std::memory_order_acquire))
+        return true;
+    if (state == State::given_back)
+        _state.store(State::available, std::memory_order_relaxed);
+    return state != State::taken;
+}
+
+void Deltacast::SharedResources::PreviewLease::wait_until_taken_back()
+{
+    using namespace std::chrono_literals;
+    while (!take_back())
+        _given_back.wait_for(100ms, [&]{ return _state.load(std::memory_order_acquire) != State::taken; });
+}
+
+std::optional<Deltacast::SharedResources::PreviewLease::LentFrame> Deltacast::SharedResources::PreviewLease::wait_for_frame(std::chrono::milliseconds timeout)
+{
+    State state = State::lent;
+    if (!_lent.wait_for(timeout, [&]{ return _state.load(std::memory_order_relaxed) == State::lent; })
+        || !_state.compare_exchange_strong(state, State::taken, std::memory_order_acquire))
+        return std::nullopt;
+    return _frame;
 }
 
-std::unique_lock<std::mutex> Deltacast::SharedResources::Synchronization::lock()
+void Deltacast::SharedResources::PreviewLease::give_back()
 {
-    return std::unique_lock(mutex);
+    _state.store(State::given_back, std::memory_order_release);
+    _given_back.notify();
 }
 
 void Deltacast::SharedResources::reset()
 {
     synchronization.stop_is_requested = false;
-    synchronization.incoming_signal_changed = false;
-    buffer = nullptr;
-    buffer_size = 0;
+    synchronization.signal_event = SignalEvent::none;
+    frames.reset(frame_ring_depth);
+    late_frames = 0;
+    repeated_overlays = 0;
 }
@@ -15,43 +15,190 @@
 
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
 #include <chrono>
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "VideoMasterHD_Core.h"
 
+#include "latency_controller.hpp"
+#include "metrics.hpp"
+#include "notifier.hpp"
+#include "processing.hpp"
+#include "quality_controller.hpp"
+#include "statistics.hpp"
+#include "triple_buffer.hpp"
+
 namespace Deltacast
 {
     struct SharedResources
     {
+        struct Frame
+        {
+            UBYTE* buffer = nullptr;
+            ULONG buffer_size = 0;
+            Application::Statistics::FrameTimestamps timestamps;
+        };
+
+        // Bounded single-producer (RX) single-consumer (TX) ring of in-flight frames.
+        // Entries are published by the producer, released by the consumer once processed and then
+        // reclaimed by the producer, which owns the underlying slots.
+        class FrameRing
+        {
+        public:
+            void reset(unsigned int depth);
+            unsigned int depth() const;
+
+            Frame& next();
+            unsigned int next_index() const;
+            void publish();
+            std::optional<unsigned int> reclaim();
+
+            unsigned int pending() const;
+            const Frame& front() const;
+            void release();
+
+        private:
+            std::vector<Frame> _frames;
+            std::atomic<uint64_t> _published = 0;
+            std::atomic<uint64_t> _released = 0;
+            std::atomic<uint64_t> _reclaimed = 0;
+        } frames;
+
+        // Changes of the incoming signal or of the genlock that require the streams to be configured again
+        enum class SignalEvent
+        {
+            none,
+            signal_lost,
+            standard_changed,
+            genlock_lost,
+        };
+
         class Synchronization
         {
         public:
+            explicit Synchronization(FrameRing& frames) : frames(frames) {}
+
             std::atomic_bool stop_is_requested = false;
-            std::atomic_bool incoming_signal_changed = false;
+            // First signal event posted since the streams were last configured
+            std::atomic<SignalEvent> signal_event = SignalEvent::none;
+            bool incoming_signal_changed() const { return signal_event != SignalEvent::none; }
 
             bool wait_until_ready_to_process();
             void notify_processing_finished();
             bool wait_until_processed();
             void notify_ready_to_process();
+            // Posts the event and wakes the waiting RX and TX threads up so that they stop without waiting for their timeout
+            void notify_signal_event(SignalEvent event);
 
-            std::unique_lock<std::mutex> lock();
+            void configure_wakeup(Application::Threading::Notifier::Mode mode, std::chrono::microseconds spin_budget);
+            const Application::Threading::Notifier& ready_to_process_notifier() const;
+            const Application::Threading::Notifier& processed_notifier() const;
 
         private:
-            std::mutex mutex;
-            std::condition_variable condition_variable;
+            Application::Threading::Notifier ready_to_process;
+            Application::Threading::Notifier processed;
 
-            bool to_process = false;
-            bool processed = false;
-        } synchronization;
+            FrameRing& frames;
+        } synchronization{frames};
 
-        UBYTE* buffer = nullptr;
-        ULONG buffer_size = 0;
+        // Pauses the pipeline threads of the channel while its streams are reconfigured for a new signal, then resumes them
+        class Reconfiguration
+        {
+        public:
+            // Pipeline threads: waits until the streams have been configured since the given generation, returns false once stopped
+            bool wait_until_resumed(uint64_t& generation, const std::atomic_bool& stop_is_requested);
+            void notify_paused();
+
+            // Channel thread
+            void resume(unsigned int number_of_threads);
+            void wait_until_paused();
+
+        private:
+            std::mutex _mutex;
+            std::condition_variable _condition_variable;
+            uint64_t _generation = 0;
+            unsigned int _running_threads = 0;
+        } reconfiguration;
+
+        // Phases of the last startup or reconfiguration, reported by the TX thread with its first output frame
+        Application::Statistics::PhaseTimings configuration_timings;
+
+        Application::Statistics::PipelineLatency latency;
+
+        struct Overlay
+        {
+            std::vector<uint8_t> buffer;
+            Application::Statistics::FrameTimestamps timestamps;
+        };
+
+        // Latest overlay completed by the overlay generation thread in asynchronous overlay mode, keyed by the TX thread at every output frame
+        Application::Threading::TripleBuffer<Overlay> overlays;
+        // Output frames keyed with an overlay that had already been keyed
+        std::atomic<unsigned int> repeated_overlays = 0;
+
+        // Captured frame lent by the RX thread to the renderer, which downscales it into the preview window on its own thread and gives it back.
+        // The RX thread keeps the slot of the lent frame until then, and replaces a frame the renderer has not taken yet by the next one.
+        class PreviewLease
+        {
+        public:
+            struct LentFrame
+            {
+                const UBYTE* buffer;
+                Application::Processing::FrameDescriptor frame_descriptor;
+            };
+
+            PreviewLease();
+
+            // RX thread: returns false while the renderer holds the previously lent frame
+            bool lend(const LentFrame& frame);
+            // RX thread: returns true once no frame is lent anymore, the frame not taken yet being withdrawn
+            bool take_back();
+            // RX thread: withdraws the frame, or waits until the renderer gives it back
+            void wait_until_taken_back();
+
+            // Renderer thread
+            std::optional<LentFrame> wait_for_frame(std::chrono::milliseconds timeout);
+            void give_back();
+
+        private:
+            enum class State
+            {
+                available,
+                lent,
+                taken,
+                given_back,
+            };
+
+            std::atomic<State> _state = State::available;
+            LentFrame _frame = {};
+            Application::Threading::Notifier _lent;
+            Application::Threading::Notifier _given_back;
+        } preview;
+        bool preview_enabled = false;
+        unsigned int preview_scale;
 
         unsigned int maximum_latency;
+        unsigned int frame_ring_depth;
+
+        // Prefixes the messages of the channel when several of them run at once
+        std::string log_prefix;
+        std::chrono::nanoseconds frame_period = std::chrono::nanoseconds(0);
+        // Time given to the processing of a frame from its capture, within the latency budget
+        std::chrono::nanoseconds processing_budget = std::chrono::nanoseconds(0);
+        // Frames whose processing finished after their deadline
+        std::atomic<unsigned int> late_frames = 0;
+        // Skips frames ahead of time to hold the TX buffer queue at maximum_latency - 2 frames
+        Application::Control::LatencyController latency_controller;
+        // Lowers the quality level of the processing when its recent timings no longer fit the processing budget
+        Application::Control::QualityController quality_controller;
+        // Cumulative counters and current gauges of the channel, exported while it runs
+        Application::Metrics::ChannelMetrics metrics;
 
         void reset();
     };
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal_monitor.hpp"
+
+#include <thread>
+
+namespace Application::Backend
+{
+    const char* to_string(SignalEvent signal_event)
+    {
+        switch (signal_event)
+        {
+            case SignalEvent::none: return "none";
+            case SignalEvent::signal_lost: return "signal lost";
+            case SignalEvent::standard_changed: return "signal standard changed";
+            case SignalEvent::genlock_lost: return "genlock lost";
+        }
+        return "unknown";
+    }
+
+    SignalMonitor::SignalMonitor(Device& device, Deltacast::SharedResources::Synchronization& synchronization)
+        : _device(device)
+        , _synchronization(synchronization)
+    {
+    }
+
+    bool SignalMonitor::wait_for_signal(Stream& rx_stream)
+    {
+        while (!_synchronization.stop_is_requested && !rx_stream.signal_present())
+            std::this_thread::sleep_for(idle_polling_period);
+
+        return !_synchronization.stop_is_requested;
+    }
+
+    bool SignalMonitor::wait_for_genlock()
+    {
+        while (!_synchronization.stop_is_requested && !_device.genlock_locked())
+            std::this_thread::sleep_for(idle_polling_period);
+
+        return !_synchronization.stop_is_requested;
+    }
+
+    SignalEvent SignalMonitor::watch(Stream& rx_stream, const Helper::SignalInformation& signal_information, bool genlocked
+                                   , std::chrono::nanoseconds frame_period, Statistics::Clock::time_point until)
+    {
+        const auto polling_period = std::chrono::duration_cast<Statistics::Clock::duration>(frame_period.count() > 0 ? frame_period : std::chrono::nanoseconds(idle_polling_period));
+        auto next_check = Statistics::Clock::now();
+        while (!_synchronization.stop_is_requested)
+        {
+            const SignalEvent signal_event = check(rx_stream, signal_information, genlocked);
+            if (signal_event != SignalEvent::none)
+            {
+                _synchronization.notify_signal_event(signal_event);
+                return signal_event;
+            }
+
+            next_check += polling_period;
+            if (next_check >= until)
+            {
+                std::this_thread::sleep_until(until);
+                break;
+            }
+            std::this_thread::sleep_until(next_check);
+        }
+        return SignalEvent::none;
+    }
+
+    SignalEvent SignalMonitor::check(Stream& rx_stream, const Helper::SignalInformation& signal_information, bool genlocked)
+    {
+        if (!rx_stream.signal_present())
+            return SignalEvent::signal_lost;
+        if (rx_stream.detect_information() != signal_information)
+            return SignalEvent::standard_changed;
+        if (genlocked && !_device.genlock_locked())
+            return SignalEvent::genlock_lost;
+        return SignalEvent::none;
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include "backend.hpp"
+#include "shared_resources.hpp"
+#include "statistics.hpp"
+
+namespace Application::Backend
+{
+    using SignalEvent = Deltacast::SharedResources::SignalEvent;
+
+    const char* to_string(SignalEvent signal_event);
+
+    // Watches the presence and the standard of the incoming signal of a channel and the lock of its genlock.
+    // While the streams run, they are checked once per frame period and the first change is posted to the pipeline threads at once.
+    class SignalMonitor
+    {
+    public:
+        // Polling period while no signal is known, shorter than the frame period of any standard
+        static constexpr std::chrono::milliseconds idle_polling_period = std::chrono::milliseconds(5);
+
+        SignalMonitor(Device& device, Deltacast::SharedResources::Synchronization& synchronization);
+
+        // Return false once the channel is stopped
+        bool wait_for_signal(Stream& rx_stream);
+        bool wait_for_genlock();
+
+        // Checks the signal the streams are configured for until it changes, which is then posted, or until the given time.
+        // Returns the posted event, or none.
+        SignalEvent watch(Stream& rx_stream, const Helper::SignalInformation& signal_information, bool genlocked
+                        , std::chrono::nanoseconds frame_period, Statistics::Clock::time_point until);
+
+    private:
+        SignalEvent check(Stream& rx_stream, const Helper::SignalInformation& signal_information, bool genlocked);
+
+        Device& _device;
+        Deltacast::SharedResources::Synchronization& _synchronization;
+    };
+}
@@ -0,0 +1,384 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simulated_backend.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Application::Backend
+{
+    const std::map<std::string, Helper::DvSignalInformation>& simulated_standards()
+    {
+        static const std::map<std::string, Helper::DvSignalInformation> standards = {
+            { "720p50", { 1280, 720, true, 50, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "720p60", { 1280, 720, true, 60, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "1080p30", { 1920, 1080, true, 30, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "1080p50", { 1920, 1080, true, 50, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "1080p60", { 1920, 1080, true, 60, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "2160p30", { 3840, 2160, true, 30, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "2160p50", { 3840, 2160, true, 50, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "2160p60", { 3840, 2160, true, 60, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+            { "4320p30", { 7680, 4320, true, 30, VHD_DV_CS_RGB_FULL, VHD_DV_SAMPLING_4_4_4_8BITS } },
+        };
+        return standards;
+    }
+
+    SimulatedSignal::SimulatedSignal(std::vector<std::optional<Helper::DvSignalInformation>> standards, std::chrono::milliseconds switch_period)
+        : _standards(std::move(standards))
+        , _switch_period(switch_period)
+        , _start(std::chrono::steady_clock::now())
+    {
+    }
+
+    std::optional<Helper::DvSignalInformation> SimulatedSignal::current() const
+    {
+        if (_standards.size() == 1 || _switch_period.count() <= 0)
+            return _standards.front();
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start);
+        return _standards[(elapsed / _switch_period) % _standards.size()];
+    }
+
+    Helper::DvSignalInformation SimulatedSignal::first_present() const
+    {
+        return **std::find_if(_standards.begin(), _standards.end(), [](const auto& standard) { return standard.has_value(); });
+    }
+
+    SimulatedSlot::SimulatedSlot(SimulatedStream& stream, unsigned int index)
+        : _stream(stream)
+        , _index(index)
+    {
+    }
+
+    SimulatedSlot::~SimulatedSlot()
+    {
+        _stream.release(_index);
+    }
+
+    std::pair<uint8_t*, uint32_t> SimulatedSlot::buffer()
+    {
+        return { _stream.buffer(_index), _stream.buffer_size() };
+    }
+
+    SimulatedStream::SimulatedStream(Direction direction, std::shared_ptr<const SimulatedSignal> signal, unsigned int number_of_slots)
+        : _direction(direction)
+        , _signal(std::move(signal))
+        , _number_of_slots(number_of_slots)
+    {
+        const auto signal_information = _signal->first_present();
+        configure(signal_information, Helper::get_frame_descriptor(signal_information, VHD_BUFPACK_VIDEO_RGB_24));
+    }
+
+    SimulatedStream::~SimulatedStream()
+    {
+        stop();
+    }
+
+    void SimulatedStream::configure(const Helper::DvSignalInformation& signal_information, const Processing::FrameDescriptor& frame_descriptor)
+    {
+        _signal_information = signal_information;
+        _frame_descriptor = frame_descriptor;
+        const uint32_t width = frame_descriptor.width, height = frame_descriptor.height;
+
+        _buffers.assign(_number_of_slots, std::vector<uint8_t>(frame_descriptor.size(), 0));
+        _free.clear();
+        _queued.clear();
+        _on_air.reset();
+        for (unsigned int i = 0; i < _number_of_slots; ++i)
+            _free.push_back(i);
+
+        _pattern.clear();
+        _marker.clear();
+        if (_direction == Direction::rx)
+        {
+            // The pattern is drawn in RGB 8-bit and converted to the capture format
+            const auto convert = Conversions::find_conversion(Processing::PixelFormat::rgb_24, frame_descriptor.pixel_format);
+            static const uint8_t bars[8][3] = { { 0xC0, 0xC0, 0xC0 }, { 0xC0, 0xC0, 0x00 }, { 0x00, 0xC0, 0xC0 }, { 0x00, 0xC0, 0x00 }
+                                              , { 0xC0, 0x00, 0xC0 }, { 0xC0, 0x00, 0x00 }, { 0x00, 0x00, 0xC0 }, { 0x10, 0x10, 0x10 } };
+            std::vector<uint8_t> rgb_line(width * 3);
+            _pattern.resize(frame_descriptor.size());
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t component = 0; component < 3; ++component)
+                        rgb_line[x * 3 + component] = (y < height * 3 / 4) ? bars[x * 8 / width][component] : static_cast<uint8_t>(x * 255 / width);
+                }
+                convert(rgb_line.data(), _pattern.data() + y * frame_descriptor.line_stride, width);
+            }
+
+            const uint32_t marker_width = std::max(width / 64, 1u);
+            const std::vector<uint8_t> white(marker_width * 3, 0xFF);
+            _marker.resize(Processing::line_size(frame_descriptor.pixel_format, marker_width));
+            convert(white.data(), _marker.data(), marker_width);
+        }
+    }
+
+    void SimulatedStream::start()
+    {
+        _device_thread = std::thread(&SimulatedStream::device_loop, this);
+    }
+
+    void SimulatedStream::stop()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _condition_variable.notify_all();
+
+        if (_device_thread.joinable())
+            _device_thread.join();
+
+        std::lock_guard lock(_mutex);
+        _stop = false;
+    }
+
+    std::unique_ptr<Slot> SimulatedStream::pop_slot()
+    {
+        auto& available = (_direction == Direction::rx) ? _queued : _free;
+
+        std::unique_lock lock(_mutex);
+        if (!_condition_variable.wait_for(lock, std::chrono::milliseconds(100), [&]{ return _stop || !available.empty(); }) || _stop)
+            return nullptr;
+
+        const unsigned int index = available.front();
+        available.pop_front();
+        if (_application_buffers)
+            return std::make_unique<ApplicationBufferSlot>(*_application_buffers, index);
+        return std::make_unique<SimulatedSlot>(*this, index);
+    }
+
+    unsigned int SimulatedStream::filling()
+    {
+        std::lock_guard lock(_mutex);
+        return static_cast<unsigned int>(_queued.size());
+    }
+
+    unsigned int SimulatedStream::slots_count()
+    {
+        std::lock_guard lock(_mutex);
+        return _slots_count;
+    }
+
+    unsigned int SimulatedStream::slots_dropped()
+    {
+        std::lock_guard lock(_mutex);
+        return _slots_dropped;
+    }
+
+    bool SimulatedStream::signal_present()
+    {
+        return _signal->current().has_value();
+    }
+
+    Helper::SignalInformation SimulatedStream::detect_information()
+    {
+        return _signal->current().value_or(_signal_information);
+    }
+
+    void SimulatedStream::attach_application_buffers(ApplicationBuffers& application_buffers)
+    {
+        std::lock_guard lock(_mutex);
+        _application_buffers = &application_buffers;
+        _buffers.clear();
+        _free.clear();
+        _queued.clear();
+
+        if (_direction == Direction::rx)
+        {
+            for (unsigned int i = 0; i < application_buffers.size(); ++i)
+                _free.push_back(i);
+            application_buffers.set_recycler([this](unsigned int index) { release(index); });
+        }
+    }
+
+    void SimulatedStream::send_application_buffer(unsigned int index)
+    {
+        _application_buffers->acquire(index);
+        release(index);
+    }
+
+    void SimulatedStream::collect_sent_application_buffers()
+    {
+        std::deque<unsigned int> sent;
+        {
+            std::lock_guard lock(_mutex);
+            sent.swap(_free);
+        }
+
+        for (unsigned int index : sent)
+            _application_buffers->release(index);
+    }
+
+    uint8_t* SimulatedStream::buffer(unsigned int index)
+    {
+        return _application_buffers ? _application_buffers->buffer(index) : _buffers[index].data();
+    }
+
+    uint32_t SimulatedStream::buffer_size() const
+    {
+        return _application_buffers ? _application_buffers->buffer_size() : static_cast<uint32_t>(_buffers.front().size());
+    }
+
+    void SimulatedStream::release(unsigned int index)
+    {
+        {
+            std::lock_guard lock(_mutex);
+            if (_direction == Direction::rx)
+                _free.push_back(index);
+            else
+            {
+                _queued.push_back(index);
+                ++_slots_count;
+            }
+        }
+        _condition_variable.notify_all();
+    }
+
+    void SimulatedStream::device_loop()
+    {
+        const auto frame_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / std::max(_signal_information.framerate, 1u);
+        auto next_tick = std::chrono::steady_clock::now() + frame_period;
+
+        for (uint64_t frame_count = 0; ; ++frame_count, next_tick += frame_period)
+        {
+            {
+                std::unique_lock lock(_mutex);
+                if (_condition_variable.wait_until(lock, next_tick, [&]{ return _stop; }))
+                    return;
+            }
+
+            if (_direction == Direction::rx)
+            {
+                std::optional<unsigned int> index;
+                {
+                    std::lock_guard lock(_mutex);
+                    if (_free.empty())
+                        ++_slots_dropped;
+                    else
+                    {
+                        index = _free.front();
+                        _free.pop_front();
+                    }
+                }
+                if (!index)
+                    continue;
+
+                capture(*index, frame_count);
+
+                {
+                    std::lock_guard lock(_mutex);
+                    _queued.push_back(*index);
+                    ++_slots_count;
+                }
+            }
+            else
+            {
+                std::lock_guard lock(_mutex);
+                if (_queued.empty())
+                {
+                    if (_on_air)
+                        ++_slots_dropped;
+                    continue;
+                }
+
+                if (_on_air)
+                    _free.push_back(*_on_air);
+                _on_air = _queued.front();
+                _queued.pop_front();
+            }
+            _condition_variable.notify_all();
+        }
+    }
+
+    void SimulatedStream::capture(unsigned int index, uint64_t frame_count)
+    {
+        uint8_t* captured_buffer = buffer(index);
+        memcpy(captured_buffer, _pattern.data(), std::min<size_t>(buffer_size(), _pattern.size()));
+
+        // The marker moves by whole pixel groups so that it keeps the packing intact
+        const Processing::FrameDescriptor& frame_descriptor = _frame_descriptor;
+        const uint32_t group_pixels = Processing::pixel_group(frame_descriptor.pixel_format).pixels;
+        const uint32_t marker_width = std::max(frame_descriptor.width / 64, 1u);
+        const uint32_t marker_position = static_cast<uint32_t>((frame_count * marker_width) % frame_descriptor.width) / group_pixels * group_pixels;
+        const uint32_t marker_offset = Processing::line_size(frame_descriptor.pixel_format, marker_position);
+        const uint32_t marker_size = std::min<uint32_t>(static_cast<uint32_t>(_marker.size()), Processing::line_size(frame_descriptor.pixel_format, frame_descriptor.width) - marker_offset);
+        for (uint32_t y = 0; y < frame_descriptor.height; ++y)
+            memcpy(captured_buffer + y * frame_descriptor.line_stride + marker_offset, _marker.data(), marker_size);
+    }
+
+    SimulatedDevice::SimulatedDevice(std::shared_ptr<const SimulatedSignal> signal, unsigned int number_of_slots)
+        : _signal(std::move(signal))
+        , _number_of_slots(number_of_slots)
+    {
+    }
+
+    std::unique_ptr<Stream> SimulatedDevice::open_rx_stream()
+    {
+        return std::make_unique<SimulatedStream>(SimulatedStream::Direction::rx, _signal, _number_of_slots);
+    }
+
+    std::unique_ptr<Stream> SimulatedDevice::open_tx_stream()
+    {
+        return std::make_unique<SimulatedStream>(SimulatedStream::Direction::tx, _signal, _number_of_slots);
+    }
+
+    Processing::FrameDescriptor SimulatedDevice::configure_rx_stream(Stream& rx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format)
+    {
+        const auto frame_descriptor = Helper::get_frame_descriptor(signal_information, Helper::to_buffer_packing(pixel_format).value());
+        static_cast<SimulatedStream&>(rx_stream).configure(std::get<Helper::DvSignalInformation>(signal_information), frame_descriptor);
+        return frame_descriptor;
+    }
+
+    Processing::FrameDescriptor SimulatedDevice::configure_tx_stream(Stream& tx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format)
+    {
+        const auto frame_descriptor = Helper::get_frame_descriptor(signal_information, Helper::to_buffer_packing(pixel_format).value());
+        static_cast<SimulatedStream&>(tx_stream).configure(std::get<Helper::DvSignalInformation>(signal_information), frame_descriptor);
+        return frame_descriptor;
+    }
+
+    bool SimulatedDevice::has_genlock()
+    {
+        return false;
+    }
+
+    void SimulatedDevice::configure_genlock(const Helper::SignalInformation& /*signal_information*/)
+    {
+    }
+
+    bool SimulatedDevice::genlock_locked()
+    {
+        return true;
+    }
+
+    void SimulatedDevice::configure_keyer()
+    {
+    }
+
+    void SimulatedDevice::disable_keyer()
+    {
+    }
+
+    void SimulatedDevice::enable_loopback()
+    {
+    }
+
+    void SimulatedDevice::disable_loopback()
+    {
+    }
+}
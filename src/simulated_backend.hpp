@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend.hpp"
+
+namespace Application::Backend
+{
+    const std::map<std::string, Helper::DvSignalInformation>& simulated_standards();
+
+    // Input signal of a simulated device, switching to the next of its standards at every switch period when it has several of them.
+    // An empty standard simulates the loss of the signal, at least one of the standards must not be empty.
+    class SimulatedSignal
+    {
+    public:
+        SimulatedSignal(std::vector<std::optional<Helper::DvSignalInformation>> standards, std::chrono::milliseconds switch_period);
+
+        std::optional<Helper::DvSignalInformation> current() const;
+        Helper::DvSignalInformation first_present() const;
+
+    private:
+        std::vector<std::optional<Helper::DvSignalInformation>> _standards;
+        std::chrono::milliseconds _switch_period;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    class SimulatedStream;
+
+    class SimulatedSlot : public Slot
+    {
+    public:
+        SimulatedSlot(SimulatedStream& stream, unsigned int index);
+        ~SimulatedSlot() override;
+
+        std::pair<uint8_t*, uint32_t> buffer() override;
+
+    private:
+        SimulatedStream& _stream;
+        unsigned int _index;
+    };
+
+    // Software stream paced at the frame rate of the simulated signal.
+    // An RX stream fills a free buffer on every frame tick and drops the frame when none is available.
+    // A TX stream sends one queued buffer on every frame tick and drops the tick when none is queued.
+    class SimulatedStream : public Stream
+    {
+    public:
+        enum class Direction
+        {
+            rx,
+            tx,
+        };
+
+        SimulatedStream(Direction direction, std::shared_ptr<const SimulatedSignal> signal, unsigned int number_of_slots);
+        ~SimulatedStream() override;
+
+        SimulatedStream(const SimulatedStream&) = delete;
+        SimulatedStream& operator=(const SimulatedStream&) = delete;
+
+        void configure(const Helper::DvSignalInformation& signal_information, const Processing::FrameDescriptor& frame_descriptor);
+
+        void start() override;
+        void stop() override;
+        std::unique_ptr<Slot> pop_slot() override;
+
+        unsigned int filling() override;
+        unsigned int slots_count() override;
+        unsigned int slots_dropped() override;
+
+        bool signal_present() override;
+        Helper::SignalInformation detect_information() override;
+
+        void attach_application_buffers(ApplicationBuffers& application_buffers) override;
+        void send_application_buffer(unsigned int index) override;
+        void collect_sent_application_buffers() override;
+
+    private:
+        friend class SimulatedSlot;
+
+        Direction _direction;
+        std::shared_ptr<const SimulatedSignal> _signal;
+        Helper::DvSignalInformation _signal_information;
+        unsigned int _number_of_slots;
+
+        std::vector<std::vector<uint8_t>> _buffers;
+        ApplicationBuffers* _application_buffers = nullptr;
+        Processing::FrameDescriptor _frame_descriptor = {};
+        std::vector<uint8_t> _pattern;
+        std::vector<uint8_t> _marker;
+
+        std::mutex _mutex;
+        std::condition_variable _condition_variable;
+        std::deque<unsigned int> _free;
+        std::deque<unsigned int> _queued;
+        std::optional<unsigned int> _on_air;
+        unsigned int _slots_count = 0;
+        unsigned int _slots_dropped = 0;
+
+        bool _stop = false;
+        std::thread _device_thread;
+
+        uint8_t* buffer(unsigned int index);
+        uint32_t buffer_size() const;
+        void release(unsigned int index);
+
+        void device_loop();
+        void capture(unsigned int index, uint64_t frame_count);
+    };
+
+    class SimulatedDevice : public Device
+    {
+    public:
+        SimulatedDevice(std::shared_ptr<const SimulatedSignal> signal, unsigned int number_of_slots);
+
+        std::unique_ptr<Stream> open_rx_stream() override;
+        std::unique_ptr<Stream> open_tx_stream() override;
+        Processing::FrameDescriptor configure_rx_stream(Stream& rx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format) override;
+        Processing::FrameDescriptor configure_tx_stream(Stream& tx_stream, const Helper::SignalInformation& signal_information, Processing::PixelFormat pixel_format) override;
+
+        bool has_genlock() override;
+        void configure_genlock(const Helper::SignalInformation& signal_information) override;
+        bool genlock_locked() override;
+
+        void configure_keyer() override;
+        void disable_keyer() override;
+
+        void enable_loopback() override;
+        void disable_loopback() override;
+
+    private:
+        std::shared_ptr<const SimulatedSignal> _signal;
+        unsigned int _number_of_slots;
+    };
+}
@@ -0,0 +1,191 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace Application::Statistics
+{
+    uint64_t Histogram::Snapshot::percentile(double percentile) const
+    {
+        if (count == 0)
+            return 0;
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * count + 0.5));
+        uint64_t cumulated_count = 0;
+        for (unsigned int i = 0; i < bucket_count; ++i)
+        {
+            cumulated_count += counts[i];
+            if (cumulated_count >= rank)
+                return std::min(bucket_upper_bound(i), max);
+        }
+        return max;
+    }
+
+    void Histogram::record(Clock::duration duration)
+    {
+        const uint64_t value = static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+
+        _counts[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+    }
+
+    Histogram::Snapshot Histogram::snapshot_and_reset()
+    {
+        Snapshot snapshot;
+        for (unsigned int i = 0; i < bucket_count; ++i)
+        {
+            snapshot.counts[i] = _counts[i].exchange(0, std::memory_order_relaxed);
+            snapshot.count += snapshot.counts[i];
+        }
+        snapshot.max = _max.exchange(0, std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    unsigned int Histogram::bucket_index(uint64_t value)
+    {
+        if (value < sub_bucket_count)
+            return static_cast<unsigned int>(value);
+
+        unsigned int most_significant_bit = 63;
+        while (!(value >> most_significant_bit))
+            --most_significant_bit;
+
+        const unsigned int octave = most_significant_bit - sub_bucket_bits;
+        return sub_bucket_count * (octave + 1) + static_cast<unsigned int>((value >> octave) & (sub_bucket_count - 1));
+    }
+
+    uint64_t Histogram::bucket_upper_bound(unsigned int index)
+    {
+        if (index < sub_bucket_count)
+            return index;
+
+        const unsigned int octave = index / sub_bucket_count - 1;
+        const uint64_t sub_bucket = index % sub_bucket_count;
+        return ((sub_bucket_count + sub_bucket + 1) << octave) - 1;
+    }
+
+    void TimingWindow::record(Clock::duration duration)
+    {
+        _durations[_next] = duration;
+        _next = (_next + 1) % size;
+        _count = std::min(_count + 1, size);
+    }
+
+    void TimingWindow::clear()
+    {
+        _count = 0;
+        _next = 0;
+    }
+
+    Clock::duration TimingWindow::percentile(unsigned int percentile) const
+    {
+        if (_count == 0)
+            return Clock::duration::zero();
+
+        std::array<Clock::duration, size> durations = _durations;
+        auto rank = durations.begin() + (_count - 1) * percentile / 100;
+        std::nth_element(durations.begin(), rank, durations.begin() + _count);
+        return *rank;
+    }
+
+    void PipelineLatency::record(const FrameTimestamps& timestamps)
+    {
+        _capture.record(timestamps.handed_off - timestamps.rx_slot_popped);
+        _handoff.record(timestamps.processing_started - timestamps.handed_off);
+        _processing.record(timestamps.processing_finished - timestamps.processing_started);
+        _transmission.record(timestamps.tx_slot_released - timestamps.processing_finished);
+        _total.record(timestamps.tx_slot_released - timestamps.rx_slot_popped);
+    }
+
+    void PipelineLatency::print_and_reset(std::ostream& os)
+    {
+        const std::pair<const char*, Histogram*> stages[] = {
+            { "RX pop to handoff", &_capture },
+            { "Handoff to processing", &_handoff },
+            { "Processing", &_processing },
+            { "Processing to TX release", &_transmission },
+            { "RX pop to TX release", &_total },
+        };
+
+        os << std::left << std::setw(26) << "Latency (us)" << std::right
+           << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::setw(10) << "frames" << std::endl;
+        for (const auto& [ name, histogram ] : stages)
+        {
+            const auto snapshot = histogram->snapshot_and_reset();
+            os << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+               << std::setw(10) << snapshot.percentile(50.0) / 1000.0
+               << std::setw(10) << snapshot.percentile(99.0) / 1000.0
+               << std::setw(10) << snapshot.percentile(99.9) / 1000.0
+               << std::setw(10) << snapshot.max / 1000.0
+               << std::setw(10) << snapshot.count << std::endl;
+        }
+        os << std::defaultfloat;
+    }
+
+    void PhaseTimings::begin(std::string title, Clock::time_point origin)
+    {
+        std::lock_guard lock(_mutex);
+        _title = std::move(title);
+        _origin = origin;
+        _phases.clear();
+        _first_output_frame_pending = false;
+        _first_output_frame_recorded = false;
+    }
+
+    void PhaseTimings::record(std::string phase, Clock::time_point start)
+    {
+        const auto end = Clock::now();
+        std::lock_guard lock(_mutex);
+        _phases.push_back({ std::move(phase), start - _origin, end - _origin });
+    }
+
+    void PhaseTimings::expect_first_output_frame()
+    {
+        _first_output_frame_pending = true;
+    }
+
+    void PhaseTimings::record_first_output_frame()
+    {
+        if (!_first_output_frame_pending.load(std::memory_order_relaxed) || !_first_output_frame_pending.exchange(false))
+            return;
+
+        _first_output_frame.store(Clock::now(), std::memory_order_relaxed);
+        _first_output_frame_recorded.store(true, std::memory_order_release);
+    }
+
+    bool PhaseTimings::report_first_output_frame(std::ostream& os, const std::string& prefix)
+    {
+        std::lock_guard lock(_mutex);
+        if (!_first_output_frame_recorded.exchange(false, std::memory_order_acquire))
+            return false;
+
+        const auto first_output_frame = _first_output_frame.load(std::memory_order_relaxed);
+        std::sort(_phases.begin(), _phases.end(), [](const Phase& phase, const Phase& other) { return phase.start < other.start; });
+
+        const auto to_ms = [](Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+        os << prefix << std::left << std::setw(32) << _title + " (ms)" << std::right << std::setw(10) << "start" << std::setw(10) << "end" << std::setw(10) << "duration" << std::endl;
+        for (const auto& phase : _phases)
+            os << prefix << std::left << std::setw(32) << phase.name << std::right << std::fixed << std::setprecision(1)
+               << std::setw(10) << to_ms(phase.start) << std::setw(10) << to_ms(phase.end) << std::setw(10) << to_ms(phase.end - phase.start) << std::endl;
+        os << prefix << std::left << std::setw(32) << "First output frame" << std::right << std::fixed << std::setprecision(1) << std::setw(10) << to_ms(first_output_frame - _origin) << std::endl;
+        os << std::defaultfloat;
+        return true;
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Application::Statistics
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Log-linear histogram of durations in nanoseconds with 32 sub-buckets per power of two (about 3% precision).
+    // Recording is lock-free and can happen concurrently with snapshots.
+    class Histogram
+    {
+    public:
+        static constexpr unsigned int sub_bucket_bits = 5;
+        static constexpr unsigned int sub_bucket_count = 1u << sub_bucket_bits;
+        static constexpr unsigned int bucket_count = sub_bucket_count * (64 - sub_bucket_bits + 1);
+
+        struct Snapshot
+        {
+            std::array<uint64_t, bucket_count> counts = {};
+            uint64_t count = 0;
+            uint64_t max = 0;
+
+            uint64_t percentile(double percentile) const;
+        };
+
+        void record(Clock::duration duration);
+        Snapshot snapshot_and_reset();
+
+    private:
+        std::array<std::atomic<uint64_t>, bucket_count> _counts = {};
+        std::atomic<uint64_t> _max = 0;
+
+        static unsigned int bucket_index(uint64_t value);
+        static uint64_t bucket_upper_bound(unsigned int index);
+    };
+
+    // Durations of the last occurrences of a stage, whose high percentiles predict the next ones.
+    // Not thread-safe, meant to be owned by the thread timing the stage.
+    class TimingWindow
+    {
+    public:
+        static constexpr unsigned int size = 32;
+
+        void record(Clock::duration duration);
+        void clear();
+        bool empty() const { return _count == 0; }
+        Clock::duration percentile(unsigned int percentile) const;
+
+    private:
+        std::array<Clock::duration, size> _durations = {};
+        unsigned int _count = 0;
+        unsigned int _next = 0;
+    };
+
+    struct FrameTimestamps
+    {
+        Clock::time_point rx_slot_popped;
+        Clock::time_point handed_off;
+        Clock::time_point processing_started;
+        Clock::time_point processing_finished;
+        Clock::time_point tx_slot_released;
+    };
+
+    class PipelineLatency
+    {
+    public:
+        void record(const FrameTimestamps& timestamps);
+        // Prints the latency distribution of each stage since the previous call
+        void print_and_reset(std::ostream& os);
+
+    private:
+        Histogram _capture;
+        Histogram _handoff;
+        Histogram _processing;
+        Histogram _transmission;
+        Histogram _total;
+    };
+
+    // Start and end of the phases of a configuration of the pipeline relative to the moment it was requested, reported along with its
+    // first output frame. Phases running concurrently can be recorded from several threads.
+    class PhaseTimings
+    {
+    public:
+        void begin(std::string title, Clock::time_point origin);
+        // Records a phase that started at the given time and ends now
+        void record(std::string phase, Clock::time_point start);
+        // Called once the pipeline threads are resumed
+        void expect_first_output_frame();
+        // Called by the TX thread at every output frame, only stores the time of the first one expected
+        void record_first_output_frame();
+        // Returns true and prints the phases once the first output frame expected since begin() has been recorded, and not reported yet
+        bool report_first_output_frame(std::ostream& os, const std::string& prefix);
+
+    private:
+        struct Phase
+        {
+            std::string name;
+            Clock::duration start;
+            Clock::duration end;
+        };
+
+        std::mutex _mutex;
+        std::string _title;
+        Clock::time_point _origin;
+        std::vector<Phase> _phases;
+        std::atomic_bool _first_output_frame_pending = false;
+        std::atomic<Clock::time_point> _first_output_frame = Clock::time_point();
+        std::atomic_bool _first_output_frame_recorded = false;
+    };
+}
@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread_policy.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#elif !defined(__APPLE__)
+#include <Windows.h>
+#endif
+
+namespace Application::Threading
+{
+    namespace
+    {
+        // Threads of a role are restarted on every signal change, their diagnostics are only printed the first time
+        void report_once(const std::string& message)
+        {
+            static std::mutex mutex;
+            static std::set<std::string> reported;
+
+            std::lock_guard lock(mutex);
+            if (reported.insert(message).second)
+                std::cout << "WARNING: " << message << std::endl;
+        }
+
+        std::string to_string(const std::vector<unsigned int>& cores)
+        {
+            std::ostringstream stream;
+            for (size_t i = 0; i < cores.size(); ++i)
+                stream << (i ? "," : "") << cores[i];
+            return stream.str();
+        }
+
+    #if defined(__linux__)
+        bool has_capability(unsigned int capability)
+        {
+            std::ifstream status("/proc/self/status");
+            std::string line;
+            while (std::getline(status, line))
+            {
+                if (line.rfind("CapEff:", 0) == 0)
+                    return (std::stoull(line.substr(7), nullptr, 16) >> capability) & 1;
+            }
+            return false;
+        }
+
+        const unsigned int cap_ipc_lock = 14;
+        const unsigned int cap_sys_nice = 23;
+    #endif
+    }
+
+    void apply(const ThreadPolicy& thread_policy, const std::string& role)
+    {
+    #if defined(__linux__)
+        if (!thread_policy.cores.empty())
+        {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            for (unsigned int core : thread_policy.cores)
+                CPU_SET(core, &cpu_set);
+            const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+            if (result != 0)
+                report_once("Could not pin " + role + " threads to cores " + to_string(thread_policy.cores) + " (" + strerror(result) + ")");
+        }
+
+        if (thread_policy.priority > 0)
+        {
+            sched_param parameters = {};
+            parameters.sched_priority = static_cast<int>(thread_policy.priority);
+            const int policy = (thread_policy.scheduling_policy == SchedulingPolicy::fifo) ? SCHED_FIFO : SCHED_RR;
+            const int result = pthread_setschedparam(pthread_self(), policy, &parameters);
+            if (result == EPERM)
+                report_once("Not allowed to give " + role + " threads the real-time priority " + std::to_string(thread_policy.priority)
+                            + ", they keep the default scheduling (run as root, grant CAP_SYS_NICE or raise the rtprio limit)");
+            else if (result != 0)
+                report_once("Could not give " + role + " threads the real-time priority " + std::to_string(thread_policy.priority) + " (" + strerror(result) + ")");
+        }
+    #elif !defined(__APPLE__)
+        if (!thread_policy.cores.empty())
+        {
+            DWORD_PTR mask = 0;
+            for (unsigned int core : thread_policy.cores)
+                mask |= DWORD_PTR(1) << core;
+            if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+                report_once("Could not pin " + role + " threads to cores " + to_string(thread_policy.cores) + " (error " + std::to_string(GetLastError()) + ")");
+        }
+
+        // Windows has no real-time policies for threads, the highest priorities of the process class are used instead
+        if (thread_policy.priority > 0 && !SetThreadPriority(GetCurrentThread(), (thread_policy.priority >= 50) ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST))
+            report_once("Could not raise the priority of " + role + " threads (error " + std::to_string(GetLastError()) + ")");
+    #else
+        if (!thread_policy.cores.empty() || thread_policy.priority > 0)
+            report_once("Thread placement and priorities are not supported on this platform, " + role + " threads keep the default ones");
+    #endif
+    }
+
+    void check_privileges(unsigned int highest_priority, bool memory_locking)
+    {
+    #if defined(__linux__)
+        if (highest_priority > 0 && !has_capability(cap_sys_nice))
+        {
+            rlimit limit = {};
+            getrlimit(RLIMIT_RTPRIO, &limit);
+            if (limit.rlim_cur < highest_priority)
+                std::cout << "WARNING: Real-time priorities up to " << highest_priority << " are requested but CAP_SYS_NICE is missing and the rtprio limit is "
+                          << limit.rlim_cur << ", threads above it will keep the default scheduling" << std::endl;
+        }
+
+        if (memory_locking && !has_capability(cap_ipc_lock))
+        {
+            rlimit limit = {};
+            getrlimit(RLIMIT_MEMLOCK, &limit);
+            if (limit.rlim_cur != RLIM_INFINITY)
+                std::cout << "WARNING: CAP_IPC_LOCK is missing and the memlock limit is " << limit.rlim_cur / 1024
+                          << " kB, memory allocated from now on will not be locked" << std::endl;
+        }
+    #else
+        (void)highest_priority;
+        (void)memory_locking;
+    #endif
+    }
+
+    bool lock_memory()
+    {
+    #if defined(__linux__)
+        // With a bounded memlock limit, MCL_FUTURE would make the allocations exceeding it fail
+        rlimit limit = {};
+        getrlimit(RLIMIT_MEMLOCK, &limit);
+        const int flags = (limit.rlim_cur == RLIM_INFINITY || has_capability(cap_ipc_lock)) ? (MCL_CURRENT | MCL_FUTURE) : MCL_CURRENT;
+        if (mlockall(flags) != 0)
+        {
+            std::cout << "WARNING: Could not lock the process memory (" << strerror(errno) << "), pages may be swapped out or faulted in during processing" << std::endl;
+            return false;
+        }
+        return true;
+    #else
+        std::cout << "WARNING: Locking the whole process memory is not supported on this platform" << std::endl;
+        return false;
+    #endif
+    }
+}
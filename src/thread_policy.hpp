@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Application::Threading
+{
+    enum class SchedulingPolicy
+    {
+        fifo,
+        round_robin,
+    };
+
+    // Placement and scheduling of the threads of a role (RX, TX, renderer, processing)
+    struct ThreadPolicy
+    {
+        std::vector<unsigned int> cores;
+        SchedulingPolicy scheduling_policy = SchedulingPolicy::fifo;
+        // Real-time priority from 1 to 99, 0 keeping the default time-sharing scheduling
+        unsigned int priority = 0;
+    };
+
+    // Applies the policy to the calling thread. What cannot be applied is reported once per role and the thread keeps running.
+    void apply(const ThreadPolicy& thread_policy, const std::string& role);
+
+    // Reports at startup the missing privileges for the requested real-time priorities and memory locking
+    void check_privileges(unsigned int highest_priority, bool memory_locking);
+
+    // Locks the pages of the process in memory, the future ones only when the memory lock limit allows it
+    bool lock_memory();
+}
@@ -0,0 +1,290 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tracing.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Application::Tracing
+{
+    std::atomic_bool enabled = false;
+
+    namespace
+    {
+        std::atomic_bool dump_requested = false;
+
+        struct Event
+        {
+            const char* name;
+            const char* argument_name;
+            int64_t begin_ns;
+            int64_t duration_ns;
+            int64_t argument;
+        };
+
+        const int64_t instant_duration = -1;
+
+        // Single-producer ring that keeps the last events of its thread and can be read while the thread keeps recording.
+        // Events are stored in relaxed atomics and claimed before being written, so that the reader can discard the ones overwritten while it copied them.
+        class EventRing
+        {
+        public:
+            static constexpr uint64_t capacity = 1 << 15;
+
+            void push(const Event& event)
+            {
+                const uint64_t pushed = _pushed.load(std::memory_order_relaxed);
+                _claimed.store(pushed + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                StoredEvent& stored = _events[pushed % capacity];
+                stored.name.store(event.name, std::memory_order_relaxed);
+                stored.argument_name.store(event.argument_name, std::memory_order_relaxed);
+                stored.begin_ns.store(event.begin_ns, std::memory_order_relaxed);
+                stored.duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+                stored.argument.store(event.argument, std::memory_order_relaxed);
+                _pushed.store(pushed + 1, std::memory_order_release);
+            }
+
+            // Appends the events in the ring, oldest first
+            void read(std::vector<Event>& events) const
+            {
+                const uint64_t pushed = _pushed.load(std::memory_order_acquire);
+                const uint64_t first = (pushed > capacity) ? pushed - capacity : 0;
+                const size_t offset = events.size();
+                for (uint64_t index = first; index < pushed; ++index)
+                {
+                    const StoredEvent& stored = _events[index % capacity];
+                    events.push_back({ stored.name.load(std::memory_order_relaxed), stored.argument_name.load(std::memory_order_relaxed), stored.begin_ns.load(std::memory_order_relaxed)
+                                     , stored.duration_ns.load(std::memory_order_relaxed), stored.argument.load(std::memory_order_relaxed) });
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const uint64_t claimed = _claimed.load(std::memory_order_relaxed);
+                if (claimed > first + capacity)
+                    events.erase(events.begin() + offset, events.begin() + offset + std::min(claimed - capacity - first, pushed - first));
+            }
+
+        private:
+            struct StoredEvent
+            {
+                std::atomic<const char*> name = nullptr;
+                std::atomic<const char*> argument_name = nullptr;
+                std::atomic<int64_t> begin_ns = 0;
+                std::atomic<int64_t> duration_ns = 0;
+                std::atomic<int64_t> argument = 0;
+            };
+
+            std::unique_ptr<StoredEvent[]> _events = std::make_unique<StoredEvent[]>(capacity);
+            std::atomic<uint64_t> _claimed = 0;
+            std::atomic<uint64_t> _pushed = 0;
+        };
+
+        struct ThreadEvents
+        {
+            unsigned int id;
+            std::string name;
+            EventRing ring;
+        };
+
+        int64_t nanoseconds_of(Clock::time_point time_point)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch()).count();
+        }
+
+        void write_microseconds(std::ostream& os, int64_t nanoseconds)
+        {
+            os << nanoseconds / 1000 << "." << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+        }
+
+        class Tracer
+        {
+        public:
+            ~Tracer() { stop(); }
+
+            // Rings outlive their threads so that the events of the stopped threads are still dumped
+            ThreadEvents& add(std::string name)
+            {
+                std::lock_guard lock(_mutex);
+                auto& thread_events = *_threads.emplace_back(std::make_unique<ThreadEvents>());
+                thread_events.id = static_cast<unsigned int>(_threads.size());
+                thread_events.name = name.empty() ? "thread " + std::to_string(thread_events.id) : std::move(name);
+                return thread_events;
+            }
+
+            void rename(ThreadEvents& thread_events, std::string name)
+            {
+                std::lock_guard lock(_mutex);
+                thread_events.name = std::move(name);
+            }
+
+            bool start(const std::string& path)
+            {
+                std::lock_guard lock(_thread_mutex);
+                if (_thread.joinable())
+                    return true;
+
+                std::ofstream file(path);
+                if (!file)
+                {
+                    std::cout << "ERROR: Cannot write the trace to " << path << std::endl;
+                    return false;
+                }
+
+                _path = path;
+                _origin_ns = nanoseconds_of(Clock::now());
+                _stop = false;
+                enabled = true;
+                _thread = std::thread([this]
+                {
+                    while (!_stop)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        if (dump_requested.exchange(false))
+                            dump();
+                    }
+                });
+                return true;
+            }
+
+            void stop()
+            {
+                std::lock_guard lock(_thread_mutex);
+                if (!_thread.joinable())
+                    return;
+
+                enabled = false;
+                _stop = true;
+                _thread.join();
+                dump();
+            }
+
+        private:
+            std::mutex _mutex;
+            std::vector<std::unique_ptr<ThreadEvents>> _threads;
+            std::vector<Event> _events;
+
+            std::mutex _thread_mutex;
+            std::thread _thread;
+            std::atomic_bool _stop = false;
+            std::string _path;
+            int64_t _origin_ns = 0;
+
+            void dump()
+            {
+                const std::string temporary_path = _path + ".tmp";
+                size_t number_of_events = 0;
+                {
+                    std::ofstream file(temporary_path, std::ios::trunc);
+                    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+                    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"overlay-from-live-content\"}}";
+
+                    std::lock_guard lock(_mutex);
+                    for (const auto& thread_events : _threads)
+                    {
+                        file << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread_events->id << ",\"args\":{\"name\":\"" << thread_events->name << "\"}}";
+
+                        _events.clear();
+                        thread_events->ring.read(_events);
+                        number_of_events += _events.size();
+                        for (const auto& event : _events)
+                        {
+                            file << "," << std::endl << "{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << thread_events->id << ",\"ts\":";
+                            write_microseconds(file, event.begin_ns - _origin_ns);
+                            if (event.duration_ns == instant_duration)
+                                file << ",\"ph\":\"i\",\"s\":\"t\"";
+                            else
+                            {
+                                file << ",\"ph\":\"X\",\"dur\":";
+                                write_microseconds(file, event.duration_ns);
+                            }
+                            if (event.argument_name)
+                                file << ",\"args\":{\"" << event.argument_name << "\":" << event.argument << "}";
+                            file << "}";
+                        }
+                    }
+                    file << std::endl << "]}" << std::endl;
+                }
+
+                if (std::rename(temporary_path.c_str(), _path.c_str()) != 0)
+                    std::cout << "ERROR: Cannot write the trace to " << _path << std::endl;
+                else
+                    std::cout << "Trace of " << number_of_events << " events written to " << _path << std::endl;
+            }
+        };
+
+        Tracer& tracer()
+        {
+            static Tracer instance;
+            return instance;
+        }
+
+        thread_local ThreadEvents* thread_events = nullptr;
+
+        ThreadEvents& events_of_this_thread()
+        {
+            if (!thread_events)
+                thread_events = &tracer().add("");
+            return *thread_events;
+        }
+    }
+
+    void record(const char* name, Clock::time_point begin, Clock::time_point end, const char* argument_name /*= nullptr*/, int64_t argument /*= 0*/)
+    {
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+        events_of_this_thread().ring.push({ name, argument_name, nanoseconds_of(begin), std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(), argument });
+    }
+
+    void instant(const char* name, const char* argument_name /*= nullptr*/, int64_t argument /*= 0*/)
+    {
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+        events_of_this_thread().ring.push({ name, argument_name, nanoseconds_of(Clock::now()), instant_duration, argument });
+    }
+
+    void name_thread(const std::string& name)
+    {
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+        if (thread_events)
+            tracer().rename(*thread_events, name);
+        else
+            thread_events = &tracer().add(name);
+    }
+
+    bool start(const std::string& path)
+    {
+        return tracer().start(path);
+    }
+
+    void request_dump()
+    {
+        dump_requested = true;
+    }
+
+    void stop()
+    {
+        tracer().stop();
+    }
+}
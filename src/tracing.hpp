@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Application::Tracing
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Checked by every span before anything is recorded, so that a disabled trace only costs a relaxed load
+    extern std::atomic_bool enabled;
+
+    // Appends a complete event to the ring of the calling thread, overwriting its oldest event when full.
+    // Names must outlive the trace, such as literals.
+    void record(const char* name, Clock::time_point begin, Clock::time_point end, const char* argument_name = nullptr, int64_t argument = 0);
+    void instant(const char* name, const char* argument_name = nullptr, int64_t argument = 0);
+
+    // Records the time spent in its scope as a complete event
+    class Span
+    {
+    public:
+        explicit Span(const char* name, const char* argument_name = nullptr, int64_t argument = 0)
+            : _name(name), _argument_name(argument_name), _argument(argument)
+        {
+            if (enabled.load(std::memory_order_relaxed))
+                _begin = Clock::now();
+        }
+        ~Span()
+        {
+            if (_begin != Clock::time_point())
+                record(_name, _begin, Clock::now(), _argument_name, _argument);
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* _name;
+        const char* _argument_name;
+        int64_t _argument;
+        Clock::time_point _begin = {};
+    };
+
+    // Names the calling thread in the timeline and allocates its ring up front, so that its first span does not allocate
+    void name_thread(const std::string& name);
+
+    // Enables the recording of the last events of every thread, written to the given file in the Chrome trace event format
+    // by stop() and whenever a dump is requested, which is safe to do from a signal handler
+    bool start(const std::string& path);
+    void request_dump();
+    void stop();
+}
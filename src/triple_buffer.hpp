@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include "notifier.hpp"
+
+namespace Application::Threading
+{
+    // Hands the latest value written by a single writer over to a single reader without either of them ever waiting for the other.
+    // The writer fills the back value and publishes it, which swaps it with the middle one.
+    // The reader swaps its front value with the middle one whenever a newer value has been published.
+    template <typename Value>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer()
+        {
+            // The writer only pays for a wake-up system call when the reader is actually asleep
+            _notifier.configure(Notifier::Mode::spin_then_block, std::chrono::microseconds(0));
+        }
+
+        Value& back() { return _values[_back]; }
+
+        void publish()
+        {
+            _back = _middle.exchange(_back | updated, std::memory_order_acq_rel) & ~updated;
+            _notifier.notify();
+        }
+
+        // Returns true once a value newer than the front one has been published, which then becomes the front one
+        bool wait_for_update(std::chrono::milliseconds timeout)
+        {
+            if (!_notifier.wait_for(timeout, [&]{ return (_middle.load(std::memory_order_acquire) & updated) != 0; }))
+                return false;
+
+            _front = _middle.exchange(_front, std::memory_order_acq_rel) & ~updated;
+            return true;
+        }
+
+        const Value& front() const { return _values[_front]; }
+
+    private:
+        static constexpr unsigned int updated = 4;
+
+        std::array<Value, 3> _values;
+        unsigned int _back = 0;
+        std::atomic<unsigned int> _middle = 1;
+        unsigned int _front = 2;
+
+        Notifier _notifier;
+    };
+}
@@ -14,17 +14,19 @@
  */
 
 #include "windowed_renderer.hpp"
+#include "logger.hpp"
+#include "tracing.hpp"
 
 #include <iostream>
-#include <cstring>
 
-WindowedRenderer::WindowedRenderer(std::string window_title, int window_width, int window_height, int framerate_ms, std::atomic_bool& stop_is_requested)
+WindowedRenderer::WindowedRenderer(std::string window_title, int window_width, int window_height, int framerate_ms, std::atomic_bool& stop_is_requested
+                                 , const Application::Threading::ThreadPolicy& thread_policy /*= {}*/)
     : _window_title(window_title)
     , _window_width(window_width)
     , _window_height(window_height)
     , _framerate_ms(framerate_ms)
+    , _thread_policy(thread_policy)
     , _should_stop(stop_is_requested)
-    , _monitor_ready(false)
 {
 }
 
@@ -35,26 +37,37 @@ WindowedRenderer::~WindowedRenderer()
 
 bool WindowedRenderer::init(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format)
 {
-    _monitor_thread = std::thread(&WindowedRenderer::monitor, this, image_width, image_height, input_format);
-    while (!_monitor_ready)
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::promise<bool> initialized;
+    auto initialization = initialized.get_future();
+    _monitor_thread = std::thread(&WindowedRenderer::monitor, this, image_width, image_height, input_format, std::move(initialized));
 
-    return true;
+    return initialization.get();
+}
+
+bool WindowedRenderer::resize_image(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format)
+{
+    std::lock_guard lock(_monitor_mutex);
+    _monitor.stop();
+    if (_monitor_thread.joinable())
+        _monitor_thread.join();
+
+    return init(image_width, image_height, input_format);
 }
 
-bool WindowedRenderer::monitor(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format)
+void WindowedRenderer::monitor(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format, std::promise<bool> initialized)
 {
+    Application::Threading::apply(_thread_policy, "renderer");
+
     if (!_monitor.init(_window_width, _window_height, _window_title.c_str(), image_width, image_height, input_format))
     {
         std::cout << "ERROR: VideoViewer initialization failed" << std::endl;
-        return false;
+        initialized.set_value(false);
+        return;
     }
 
-    _monitor_ready = true;
+    initialized.set_value(true);
     _monitor.render_loop(_framerate_ms);
     _monitor.release();
-
-    return true;
 }
 
 bool WindowedRenderer::start(Deltacast::SharedResources& shared_resources)
@@ -72,42 +85,33 @@ bool WindowedRenderer::stop()
 
     _monitor.stop();
     if (_monitor_thread.joinable())
-    {
         _monitor_thread.join();
-        _monitor_ready = false;
-    }
 
     return true;
 }
 
 void WindowedRenderer::render_loop(Deltacast::SharedResources& shared_resources)
 {
-    std::unique_ptr<uint8_t> to_render_data = nullptr;
-    uint64_t to_render_data_size = 0;
-    
+    Application::Threading::apply(_thread_policy, "renderer");
+    Application::Tracing::name_thread(shared_resources.log_prefix + "renderer");
+    Application::Logging::register_thread();
+
     while (!_should_stop)
     {
-        {
-            auto lock = shared_resources.synchronization.lock();
-
-            if (shared_resources.buffer && shared_resources.buffer_size)
-            {
-                if (!to_render_data || (to_render_data_size != shared_resources.buffer_size))
-                {
-                    to_render_data.reset(new uint8_t[shared_resources.buffer_size]);
-                    to_render_data_size = shared_resources.buffer_size;
-                }
-
-                memcpy(to_render_data.get(), (uint8_t*)shared_resources.buffer, to_render_data_size);
-            }
-        }
+        // The captured frame is read from its RX slot, which is kept until the frame is given back
+        const auto frame = shared_resources.preview.wait_for_frame(std::chrono::milliseconds(_framerate_ms));
 
+        std::lock_guard lock(_monitor_mutex);
         uint8_t* monitor_data = nullptr;
         uint64_t monitor_data_size = 0;
         if (_monitor.lock_data(&monitor_data, &monitor_data_size)) 
         {
-            if (to_render_data && monitor_data && (monitor_data_size == shared_resources.buffer_size) && shared_resources.buffer)
-                memcpy(monitor_data, to_render_data.get(), monitor_data_size);
+            if (frame && monitor_data
+                && (monitor_data_size == Application::Processing::downscaled(frame->frame_descriptor, shared_resources.preview_scale).size()))
+            {
+                Application::Tracing::Span span("preview downscale", "factor", shared_resources.preview_scale);
+                Application::Processing::downscale(frame->frame_descriptor, frame->buffer, shared_resources.preview_scale, monitor_data);
+            }
 
             _monitor.unlock_data();
         }
@@ -115,5 +119,8 @@ void WindowedRenderer::render_loop(Deltacast::SharedResources& shared_resources)
         {
             _should_stop = true; 
         }
+
+        if (frame)
+            shared_resources.preview.give_back();
     }
 }
\ No newline at end of file
@@ -18,15 +18,19 @@
 #include <videoviewer/videoviewer.hpp>
 
 #include "shared_resources.hpp"
+#include "thread_policy.hpp"
 
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <future>
+#include <mutex>
 
 class WindowedRenderer
 {
 public:
-    WindowedRenderer(std::string window_title, int window_width, int window_height, int framerate_ms, std::atomic_bool& stop_is_requested);
+    WindowedRenderer(std::string window_title, int window_width, int window_height, int framerate_ms, std::atomic_bool& stop_is_requested
+                   , const Application::Threading::ThreadPolicy& thread_policy = {});
     ~WindowedRenderer();
     
     WindowedRenderer(const WindowedRenderer&) = delete;
@@ -34,7 +38,10 @@ public:
     WindowedRenderer(WindowedRenderer&&) = delete;
     WindowedRenderer& operator=(WindowedRenderer&&) = delete;
 
+    // Returns once the window is open, false if it could not be
     bool init(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format);
+    // Restarts the viewer for images of another size, keeping the rendering loop running
+    bool resize_image(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format);
     bool start(Deltacast::SharedResources& shared_resources);
     bool stop();
 
@@ -43,14 +50,15 @@ private:
     int _window_width;
     int _window_height;
     int _framerate_ms;
+    Application::Threading::ThreadPolicy _thread_policy;
 
     Deltacast::VideoViewer _monitor;
     std::thread _monitor_thread;
+    std::mutex _monitor_mutex;
 
     std::atomic_bool& _should_stop;
-    std::atomic_bool _monitor_ready;
     std::thread _rendering_loop_thread;
 
-    bool monitor(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format);
+    void monitor(int image_width, int image_height, Deltacast::VideoViewer::InputFormat input_format, std::promise<bool> initialized);
     void render_loop(Deltacast::SharedResources& shared_resources);
 };
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "worker_pool.hpp"
+#include "logger.hpp"
+#include "tracing.hpp"
+
+#include <algorithm>
+
+namespace Application::Threading
+{
+    WorkerPool::WorkerPool(std::optional<unsigned int> number_of_workers /*= std::nullopt*/, const ThreadPolicy& thread_policy /*= {}*/)
+    {
+        if (!number_of_workers)
+        {
+            const unsigned int hardware_concurrency = std::thread::hardware_concurrency();
+            number_of_workers = (hardware_concurrency > 1) ? hardware_concurrency - 1 : 0;
+        }
+
+        for (unsigned int i = 0; i < *number_of_workers; ++i)
+        {
+            ThreadPolicy worker_policy = thread_policy;
+            if (!thread_policy.cores.empty())
+                worker_policy.cores = { thread_policy.cores[i % thread_policy.cores.size()] };
+            _workers.emplace_back(&WorkerPool::worker_loop, this, worker_policy);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _wake_up.notify_all();
+
+        for (auto& worker : _workers)
+            worker.join();
+    }
+
+    unsigned int WorkerPool::concurrency() const
+    {
+        return static_cast<unsigned int>(_workers.size()) + 1;
+    }
+
+    void WorkerPool::run(unsigned int number_of_partitions, const Task& task, Clock::time_point deadline /*= Clock::time_point::max()*/)
+    {
+        if (number_of_partitions == 0)
+            return;
+
+        Job job{ &task, number_of_partitions, deadline };
+        {
+            std::lock_guard lock(_mutex);
+            _jobs.push_back(&job);
+        }
+        _wake_up.notify_all();
+
+        std::unique_lock lock(_mutex);
+        while (job.next_partition < job.number_of_partitions)
+        {
+            const unsigned int partition = take_partition(job);
+            lock.unlock();
+            {
+                Tracing::Span span("partition", "partition", partition);
+                task(partition);
+            }
+            lock.lock();
+            finish_partition(job);
+        }
+        _finished.wait(lock, [&]{ return job.finished_partitions == job.number_of_partitions; });
+    }
+
+    void WorkerPool::worker_loop(ThreadPolicy thread_policy)
+    {
+        apply(thread_policy, "processing");
+        Tracing::name_thread("processing");
+        Logging::register_thread();
+
+        std::unique_lock lock(_mutex);
+        while (true)
+        {
+            _wake_up.wait(lock, [&]{ return _stop || !_jobs.empty(); });
+            if (_stop)
+                return;
+
+            Job& job = **std::min_element(_jobs.begin(), _jobs.end(), [](const Job* a, const Job* b) { return a->deadline < b->deadline; });
+            const unsigned int partition = take_partition(job);
+            lock.unlock();
+            {
+                Tracing::Span span("partition", "partition", partition);
+                (*job.task)(partition);
+            }
+            lock.lock();
+            finish_partition(job);
+        }
+    }
+
+    unsigned int WorkerPool::take_partition(Job& job)
+    {
+        const unsigned int partition = job.next_partition++;
+        if (job.next_partition == job.number_of_partitions)
+            _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &job));
+        return partition;
+    }
+
+    void WorkerPool::finish_partition(Job& job)
+    {
+        if (++job.finished_partitions == job.number_of_partitions)
+            _finished.notify_all();
+    }
+}
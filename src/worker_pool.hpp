@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "thread_policy.hpp"
+
+namespace Application::Threading
+{
+    // Processing workers shared by every pipeline. Tasks submitted concurrently are served earliest deadline first,
+    // each submitting thread working on its own task in the meantime.
+    class WorkerPool
+    {
+    public:
+        using Task = std::function<void(unsigned int partition)>;
+        using Clock = std::chrono::steady_clock;
+
+        // No number of workers sizes the pool to the machine, the calling thread being part of the pool.
+        // Each worker is pinned to one of the cores of the policy in turn.
+        explicit WorkerPool(std::optional<unsigned int> number_of_workers = std::nullopt, const ThreadPolicy& thread_policy = {});
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        WorkerPool(WorkerPool&&) = delete;
+        WorkerPool& operator=(WorkerPool&&) = delete;
+
+        unsigned int concurrency() const;
+
+        // Runs the task on every partition and returns once all of them have been processed
+        void run(unsigned int number_of_partitions, const Task& task, Clock::time_point deadline = Clock::time_point::max());
+
+    private:
+        struct Job
+        {
+            const Task* task;
+            unsigned int number_of_partitions;
+            Clock::time_point deadline;
+            unsigned int next_partition = 0;
+            unsigned int finished_partitions = 0;
+        };
+
+        std::vector<std::thread> _workers;
+
+        std::mutex _mutex;
+        std::condition_variable _wake_up;
+        std::condition_variable _finished;
+
+        // Jobs with partitions left to start
+        std::vector<Job*> _jobs;
+        bool _stop = false;
+
+        void worker_loop(ThreadPolicy thread_policy);
+        unsigned int take_partition(Job& job);
+        void finish_partition(Job& job);
+    };
+}